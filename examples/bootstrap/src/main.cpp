@@ -11,6 +11,7 @@ struct params
 	int   K         =  32;     // number of information bits
 	int   N         = 128;     // codeword size
 	int   fe        = 100;     // number of frame errors
+	int   n_frames  =   8;     // number of frames processed per call of the modules (inter frame batching)
 	int   seed      =   0;     // PRNG seed for the AWGN channel
 	float ebn0_min  =   0.00f; // minimum SNR value
 	float ebn0_max  =  10.01f; // maximum SNR value
@@ -116,6 +117,7 @@ void init_params(params &p)
 	p.R = (float)p.K / (float)p.N;
 	std::cout << "# * Simulation parameters: "              << std::endl;
 	std::cout << "#    ** Frame errors   = " << p.fe        << std::endl;
+	std::cout << "#    ** Inter frames   = " << p.n_frames  << std::endl;
 	std::cout << "#    ** Noise seed     = " << p.seed      << std::endl;
 	std::cout << "#    ** Info. bits (K) = " << p.K         << std::endl;
 	std::cout << "#    ** Frame size (N) = " << p.N         << std::endl;
@@ -135,17 +137,26 @@ void init_modules(const params &p, modules &m)
 	m.decoder = std::unique_ptr<module::Decoder_repetition_std<>>(new module::Decoder_repetition_std<>(p.K, p.N ));
 	m.monitor = std::unique_ptr<module::Monitor_BFER          <>>(new module::Monitor_BFER          <>(p.K, p.fe));
 	m.channel->set_seed(p.seed);
+
+	// each call of the modules processes 'n_frames' frames (the monitor counts the errors per frame)
+	m.source ->set_n_frames(p.n_frames);
+	m.encoder->set_n_frames(p.n_frames);
+	m.modem  ->set_n_frames(p.n_frames);
+	m.channel->set_n_frames(p.n_frames);
+	m.decoder->set_n_frames(p.n_frames);
+	m.monitor->set_n_frames(p.n_frames);
 };
 
 void init_buffers(const params &p, buffers &b)
 {
-	b.ref_bits      = std::vector<int  >(p.K);
-	b.enc_bits      = std::vector<int  >(p.N);
-	b.symbols       = std::vector<float>(p.N);
-	b.sigma         = std::vector<float>(  1);
-	b.noisy_symbols = std::vector<float>(p.N);
-	b.LLRs          = std::vector<float>(p.N);
-	b.dec_bits      = std::vector<int  >(p.K);
+	// the frames of a batch are contiguous in the buffers
+	b.ref_bits      = std::vector<int  >(p.K * p.n_frames);
+	b.enc_bits      = std::vector<int  >(p.N * p.n_frames);
+	b.symbols       = std::vector<float>(p.N * p.n_frames);
+	b.sigma         = std::vector<float>(  1 * p.n_frames); // one noise value per frame
+	b.noisy_symbols = std::vector<float>(p.N * p.n_frames);
+	b.LLRs          = std::vector<float>(p.N * p.n_frames);
+	b.dec_bits      = std::vector<int  >(p.K * p.n_frames);
 }
 
 void init_utils(const modules &m, utils &u)
@@ -0,0 +1,103 @@
+#ifndef BARRIER_HPP_
+#define BARRIER_HPP_
+
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace aff3ct
+{
+namespace tools
+{
+/*
+ * Reusable barrier with a serial section, to keep the threads of a sequence
+ * in the same 'exec' call from one SNR point to the next: the threads that
+ * reach the stop condition of a point wait in 'wait', the last one executes
+ * 'last' (e.g. the final report and the start of the next point) while the
+ * others are still blocked, and they all return the value of 'last' (true =
+ * stop the sequence).
+ *
+ * A thread that throws (in 'last' or around 'wait') never reaches the barrier
+ * again: 'abort' releases the waiting threads and the next ones, they return
+ * true (stop). 'wait' aborts the barrier itself if 'last' throws.
+ */
+class Barrier
+{
+protected:
+	const size_t            n_threads;
+	size_t                  n_waiting;
+	size_t                  generation;
+	bool                    result;
+	std::atomic<bool>       aborted; // read without the lock by 'is_aborted'
+	std::mutex              mtx;
+	std::condition_variable cv;
+
+public:
+	explicit Barrier(const size_t n_threads)
+	: n_threads(n_threads ? n_threads : 1), n_waiting(0), generation(0), result(false), aborted(false)
+	{
+	}
+
+	Barrier(const Barrier&) = delete;
+	Barrier& operator=(const Barrier&) = delete;
+
+	/*
+	 * 'abort' is polled by the waiting threads every millisecond: if it returns true they return true without the
+	 * other threads (e.g. a thread has left the sequence and will never reach the barrier).
+	 */
+	bool wait(const std::function<bool()> &last, const std::function<bool()> &abort = nullptr)
+	{
+		std::unique_lock<std::mutex> lock(this->mtx);
+		if (this->aborted)
+			return true;
+
+		const auto gen = this->generation;
+		if (++this->n_waiting == this->n_threads)
+		{
+			try
+			{
+				this->result = last();
+			}
+			catch (...)
+			{
+				this->aborted = true;
+				this->cv.notify_all();
+				throw;
+			}
+			this->n_waiting = 0;
+			this->generation++;
+			this->cv.notify_all();
+			return this->result;
+		}
+
+		while (gen == this->generation && !this->aborted)
+		{
+			this->cv.wait_for(lock, std::chrono::milliseconds(1));
+			if (gen == this->generation && !this->aborted && abort && abort())
+			{
+				this->n_waiting--;
+				return true;
+			}
+		}
+		return this->aborted && gen == this->generation ? true : this->result;
+	}
+
+	// releases the waiting threads (and the next ones) for good, e.g. a thread has thrown and will never come back
+	void abort()
+	{
+		std::lock_guard<std::mutex> lock(this->mtx);
+		this->aborted = true;
+		this->cv.notify_all();
+	}
+
+	bool is_aborted() const
+	{
+		return this->aborted;
+	}
+};
+}
+}
+
+#endif /* BARRIER_HPP_ */
@@ -0,0 +1,137 @@
+#ifndef CHECKPOINT_HPP_
+#define CHECKPOINT_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace tools
+{
+/*
+ * Compact binary checkpoint of a BER/FER sweep: the position in the sweep and
+ * the monitor counters of the current SNR point. The file is written in
+ * '<path>.tmp' and renamed, so a killed process leaves the previous
+ * checkpoint or the new one, never a truncated file.
+ *
+ * The PRNG states of the modules are not exposed by the library: on resume,
+ * the modules are re-seeded from 'n_resumes' so the resumed frames use new
+ * noise and data streams (no frame is simulated twice with the same draws).
+ */
+class Checkpoint
+{
+public:
+	struct State
+	{
+		uint64_t key;       // configuration of the simulation (see 'make_key')
+		uint32_t point;     // index of the current SNR point in the sweep
+		uint32_t n_resumes; // number of times the simulation has been resumed
+		uint64_t n_fra;     // monitor counters of the current SNR point
+		uint64_t n_fe;
+		uint64_t n_be;
+	};
+
+protected:
+	static constexpr uint32_t magic   = 0x544b4341; // "ACKT"
+	static constexpr uint32_t version = 1;
+
+	const std::string    path;
+	const int64_t        period; // in ns (0 = no periodic checkpoint)
+	std::atomic<int64_t> deadline;
+
+public:
+	Checkpoint(const std::string &path, const std::chrono::nanoseconds period)
+	: path(path), period(period.count()), deadline(0)
+	{
+		this->rearm();
+	}
+
+	// FNV-1a hash of a description of the simulation parameters
+	static uint64_t make_key(const std::string &config)
+	{
+		uint64_t h = 14695981039346656037ull;
+		for (auto c : config)
+		{
+			h ^= (uint64_t)(unsigned char)c;
+			h *= 1099511628211ull;
+		}
+		return h;
+	}
+
+	// returns true if a checkpoint of the same configuration ('key') has been loaded in 'state'
+	bool load(const uint64_t key, State &state) const
+	{
+		std::ifstream f(this->path, std::ios::binary);
+		if (!f.is_open())
+			return false;
+
+		uint32_t m = 0, v = 0;
+		State s;
+		f.read(reinterpret_cast<char*>(&m), sizeof(m));
+		f.read(reinterpret_cast<char*>(&v), sizeof(v));
+		f.read(reinterpret_cast<char*>(&s), sizeof(s));
+		if (!f || m != magic || v != version || s.key != key)
+			return false;
+
+		state = s;
+		return true;
+	}
+
+	void save(const State &state)
+	{
+		const std::string tmp = this->path + ".tmp";
+		{
+			std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+			if (!f.is_open())
+				throw runtime_error(__FILE__, __LINE__, __func__, "Can't open the '" + tmp + "' file.");
+			const uint32_t m = magic, v = version;
+			f.write(reinterpret_cast<const char*>(&m),     sizeof(m));
+			f.write(reinterpret_cast<const char*>(&v),     sizeof(v));
+			f.write(reinterpret_cast<const char*>(&state), sizeof(state));
+			f.flush();
+			if (!f)
+				throw runtime_error(__FILE__, __LINE__, __func__, "Can't write the '" + tmp + "' file.");
+		}
+		if (std::rename(tmp.c_str(), this->path.c_str()) != 0)
+			throw runtime_error(__FILE__, __LINE__, __func__, "Can't rename '" + tmp + "' in '" + this->path + "'.");
+		this->rearm();
+	}
+
+	// the sweep is over: the next run starts from the beginning
+	void remove() const
+	{
+		std::remove(this->path.c_str());
+	}
+
+	// can be called by all the threads (e.g. in the stop condition of a 'Sequence')
+	bool is_due() const
+	{
+		if (!this->period)
+			return false;
+		return Checkpoint::now() >= this->deadline.load(std::memory_order_relaxed);
+	}
+
+	const std::string& get_path() const { return this->path; }
+
+protected:
+	void rearm()
+	{
+		this->deadline.store(Checkpoint::now() + this->period, std::memory_order_relaxed);
+	}
+
+	static int64_t now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+};
+}
+}
+
+#endif /* CHECKPOINT_HPP_ */
@@ -0,0 +1,281 @@
+#ifndef METRICS_ENDPOINT_HPP_
+#define METRICS_ENDPOINT_HPP_
+
+#include <functional>
+#include <sstream>
+#include <ostream>
+#include <cstring>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#endif
+
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace tools
+{
+/*
+ * Live metrics of a simulation in the Prometheus text format, served over HTTP
+ * ('GET /metrics') by a background thread: the same counters as the reporters
+ * of the terminal (BER/FER, throughput) and the task statistics, readable by a
+ * monitoring system instead of a person.
+ *
+ * The metrics are registered before 'start' as callbacks and the server thread
+ * calls them on each scrape only: the simulation threads never block and do
+ * nothing more than updating their own counters. This is a best-effort view,
+ * not a consistent snapshot: as for the terminal reporters, the counters are
+ * read without synchronization while the workers write them, so a value may
+ * be one frame late and two values of a scrape may not match exactly.
+ *
+ * The endpoint listens on the loopback interface by default: give another
+ * 'address' (e.g. "0.0.0.0") to publish the metrics out of the machine.
+ * POSIX only.
+ */
+class Metrics_endpoint
+{
+protected:
+	struct Sample
+	{
+		std::string             labels; // e.g. 'stage="1",task="decode"' (without the braces)
+		std::function<double()> value;
+	};
+
+	struct Family
+	{
+		std::string         name;
+		std::string         type; // "gauge" or "counter"
+		std::string         help;
+		std::vector<Sample> samples;
+	};
+
+	const int           port;
+	const std::string   address;
+	std::vector<Family> families;
+	std::atomic<bool>   stop_server;
+	std::thread         server;
+	int                 fd;
+
+public:
+	explicit Metrics_endpoint(const int port, const std::string &address = "127.0.0.1")
+	: port(port), address(address), stop_server(false), fd(-1)
+	{
+		if (port <= 0 || port > 65535)
+			throw invalid_argument(__FILE__, __LINE__, __func__, "'port' has to be in [1;65535] ('port' = " +
+			                       std::to_string(port) + ").");
+	}
+
+	virtual ~Metrics_endpoint()
+	{
+		this->stop();
+	}
+
+	Metrics_endpoint(const Metrics_endpoint&) = delete;
+	Metrics_endpoint& operator=(const Metrics_endpoint&) = delete;
+
+	// 'name' follows the Prometheus conventions (e.g. "aff3ct_frames_total" for a counter)
+	void add(const std::string &name, const std::string &type, const std::string &help,
+	         const std::function<double()> &value, const std::string &labels = "")
+	{
+		if (this->server.joinable())
+			throw runtime_error(__FILE__, __LINE__, __func__, "The metrics have to be added before 'start'.");
+		if (type != "gauge" && type != "counter")
+			throw invalid_argument(__FILE__, __LINE__, __func__, "Unknown metric type ('type' = " + type + ").");
+
+		for (auto &f : this->families)
+			if (f.name == name)
+			{
+				f.samples.push_back({labels, value});
+				return;
+			}
+		this->families.push_back({name, type, help, {{labels, value}}});
+	}
+
+	// number of calls and time spent in each task, the clones of a task are summed (e.g. 'stage->get_tasks_per_types()')
+	template <class T>
+	void add_tasks(const std::vector<std::vector<T*>> &tasks_per_types, const size_t stage = 0)
+	{
+		for (auto &tsks : tasks_per_types)
+		{
+			if (tsks.empty()) continue;
+			const std::vector<const module::Task*> clones(tsks.begin(), tsks.end());
+			const auto &mdl = clones[0]->get_module();
+			const auto labels = "stage=\"" + std::to_string(stage) + "\",module=" +
+			                    Metrics_endpoint::quote(mdl.get_custom_name().empty() ? mdl.get_name()
+			                                                                          : mdl.get_custom_name()) +
+			                    ",task=" + Metrics_endpoint::quote(clones[0]->get_name());
+
+			this->add("aff3ct_task_calls_total", "counter", "Number of calls of the task.", [clones]()
+			{
+				double n = 0.;
+				for (auto t : clones) n += (double)t->get_n_calls();
+				return n;
+			}, labels);
+			this->add("aff3ct_task_frames_total", "counter", "Number of frames processed by the task.", [clones]()
+			{
+				double n = 0.;
+				for (auto t : clones) n += (double)t->get_n_calls() * (double)t->get_module().get_n_frames();
+				return n;
+			}, labels);
+			this->add("aff3ct_task_seconds_total", "counter", "Time spent in the task.", [clones]()
+			{
+				double ns = 0.;
+				for (auto t : clones) ns += (double)t->get_duration_total().count();
+				return ns * 1e-9;
+			}, labels);
+		}
+	}
+
+	void write(std::ostream &os) const
+	{
+		std::stringstream ss;
+		ss.precision(12);
+		for (auto &f : this->families)
+		{
+			ss << "# HELP " << f.name << " " << f.help << "\n"
+			   << "# TYPE " << f.name << " " << f.type << "\n";
+			for (auto &s : f.samples)
+				ss << f.name << (s.labels.empty() ? "" : "{" + s.labels + "}") << " " << s.value() << "\n";
+		}
+		os << ss.str();
+	}
+
+	void start()
+	{
+		if (this->server.joinable())
+			return;
+#if defined(__unix__) || defined(__APPLE__)
+		this->fd = ::socket(AF_INET, SOCK_STREAM, 0);
+		if (this->fd == -1)
+			throw runtime_error(__FILE__, __LINE__, __func__, "Can't create the socket of the metrics endpoint.");
+
+		const int yes = 1;
+		::setsockopt(this->fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+		sockaddr_in addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_port   = htons((uint16_t)this->port);
+		if (::inet_pton(AF_INET, this->address.c_str(), &addr.sin_addr) != 1 ||
+		    ::bind(this->fd, (sockaddr*)&addr, sizeof(addr)) == -1 || ::listen(this->fd, 8) == -1)
+		{
+			::close(this->fd);
+			this->fd = -1;
+			throw runtime_error(__FILE__, __LINE__, __func__, "Can't listen on " + this->address + ":" +
+			                    std::to_string(this->port) + ".");
+		}
+
+		this->stop_server = false;
+		this->server = std::thread([this]() { this->serve(); });
+#else
+		throw runtime_error(__FILE__, __LINE__, __func__, "'Metrics_endpoint' requires a POSIX system.");
+#endif
+	}
+
+	void stop()
+	{
+		this->stop_server = true;
+		if (this->server.joinable())
+			this->server.join();
+#if defined(__unix__) || defined(__APPLE__)
+		if (this->fd != -1)
+			::close(this->fd);
+#endif
+		this->fd = -1;
+	}
+
+	int get_port() const { return this->port; }
+
+protected:
+#if defined(__unix__) || defined(__APPLE__)
+	// one request per connection, the listening socket is polled to check 'stop_server' every 100 ms
+	void serve()
+	{
+		while (!this->stop_server)
+		{
+			pollfd pfd = { this->fd, POLLIN, 0 };
+			if (::poll(&pfd, 1, 100) <= 0 || !(pfd.revents & POLLIN))
+				continue;
+
+			const int client = ::accept(this->fd, nullptr, nullptr);
+			if (client == -1)
+				continue;
+
+			// the request line is enough (a scraper never sends a body)
+			std::string request;
+			char buf[1024];
+			pollfd cfd = { client, POLLIN, 0 };
+			while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192 &&
+			       ::poll(&cfd, 1, 1000) > 0)
+			{
+				const auto n = ::recv(client, buf, sizeof(buf), 0);
+				if (n <= 0) break;
+				request.append(buf, (size_t)n);
+			}
+
+			std::string status = "200 OK", body;
+			if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 6, "GET / ") == 0)
+			{
+				std::stringstream ss;
+				this->write(ss);
+				body = ss.str();
+			}
+			else
+			{
+				status = "404 Not Found";
+				body   = "Not found, the metrics are served on /metrics.\n";
+			}
+
+			const auto response = "HTTP/1.0 " + status + "\r\n"
+			                      "Content-Type: text/plain; version=0.0.4\r\n"
+			                      "Content-Length: " + std::to_string(body.size()) + "\r\n"
+			                      "Connection: close\r\n\r\n" + body;
+			Metrics_endpoint::send_all(client, response);
+			::close(client);
+		}
+	}
+
+	static void send_all(const int client, const std::string &data)
+	{
+#ifdef MSG_NOSIGNAL
+		const int flags = MSG_NOSIGNAL; // no SIGPIPE if the scraper has closed the connection
+#else
+		const int flags = 0;
+#endif
+		size_t sent = 0;
+		while (sent < data.size())
+		{
+			const auto n = ::send(client, data.data() + sent, data.size() - sent, flags);
+			if (n <= 0) return;
+			sent += (size_t)n;
+		}
+	}
+#else
+	void serve() {}
+#endif
+
+	static std::string quote(const std::string &str)
+	{
+		std::string q = "\"";
+		for (auto c : str)
+		{
+			if      (c == '"' || c == '\\') { q += '\\'; q += c; }
+			else if (c == '\n')             { q += "\\n";        }
+			else                            { q += c;            }
+		}
+		return q + "\"";
+	}
+};
+}
+}
+
+#endif /* METRICS_ENDPOINT_HPP_ */
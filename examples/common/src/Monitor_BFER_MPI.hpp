@@ -0,0 +1,186 @@
+#ifndef MONITOR_BFER_MPI_HPP_
+#define MONITOR_BFER_MPI_HPP_
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+
+#include <mpi.h>
+#include <aff3ct.hpp>
+
+#include "Monitor_BFER_counter.hpp"
+
+namespace aff3ct
+{
+namespace tools
+{
+/*
+ * Reduction of the 'Monitor_BFER' counters over the MPI ranks (each rank runs
+ * its own multi-threaded 'Sequence') and cluster-wide stop criterion.
+ *
+ * During the simulation, the frame error estimates of the ranks (from their
+ * 'Monitor_BFER_counter') are summed by non-blocking 'MPI_Iallreduce' rounds,
+ * progressed by one thread at a time of each rank from the stop condition of
+ * the sequence ('is_done'). A new round starts 'period' after the end of the
+ * previous one. All the ranks get the same result for a given round, so they
+ * all stop after the same round: there is never a pending collective between
+ * two SNR points. 'reduce' exactly sums the counters of the ranks at the end of
+ * a SNR point, and tells all the ranks whether one of them wants to end the
+ * simulation (so they all leave the SNR loop after the same point).
+ *
+ * Requires the 'MPI_THREAD_SERIALIZED' thread level (see 'MPI_Init_thread').
+ */
+template <typename B = int>
+class Monitor_BFER_MPI
+{
+public:
+	using Reduction = Monitor_reduction<module::Monitor_BFER<B>>;
+
+protected:
+	Reduction               &reduction;
+	Monitor_BFER_counter<B> &counter;
+	module::Monitor_BFER<B> &collector; // local monitor where the counters of the other ranks are added
+	MPI_Comm                 comm;
+	const uint64_t           fe_limit;
+	const int64_t            period; // in ns
+	int                      rank;
+	int                      size;
+
+	// state of the current round, only accessed by the thread that holds 'busy'
+	uint64_t                 send[2]; // local frame errors and stop vote
+	uint64_t                 recv[2]; // cluster-wide frame errors and number of stop votes
+	MPI_Request              request;
+	bool                     in_flight;
+	int64_t                  next_round; // in ns
+
+	std::atomic<bool>        busy;
+	std::atomic<bool>        stop_vote; // a local stop condition is met (e.g. the user pressed Ctrl+c)
+	std::atomic<bool>        done;
+	std::atomic<uint64_t>    n_fe;      // cluster-wide frame errors of the last round
+
+public:
+	Monitor_BFER_MPI(Reduction &reduction, Monitor_BFER_counter<B> &counter, module::Monitor_BFER<B> &collector,
+	                 const size_t fe_limit,
+	                 const std::chrono::nanoseconds period = std::chrono::milliseconds(10),
+	                 MPI_Comm comm = MPI_COMM_WORLD)
+	: reduction(reduction),
+	  counter(counter),
+	  collector(collector),
+	  comm(comm),
+	  fe_limit(fe_limit),
+	  period(period.count()),
+	  rank(0),
+	  size(1),
+	  request(MPI_REQUEST_NULL),
+	  in_flight(false),
+	  next_round(0),
+	  busy(false),
+	  stop_vote(false),
+	  done(false),
+	  n_fe(0)
+	{
+		int provided;
+		MPI_Query_thread(&provided);
+		if (provided < MPI_THREAD_SERIALIZED)
+			throw runtime_error(__FILE__, __LINE__, __func__, "MPI has to be initialized with (at least) the "
+			                                                  "'MPI_THREAD_SERIALIZED' thread level.");
+		MPI_Comm_rank(this->comm, &this->rank);
+		MPI_Comm_size(this->comm, &this->size);
+	}
+
+	Monitor_BFER_MPI(const Monitor_BFER_MPI&) = delete;
+	Monitor_BFER_MPI& operator=(const Monitor_BFER_MPI&) = delete;
+
+	int get_rank() const { return this->rank; }
+	int get_size() const { return this->size; }
+
+	// cluster-wide frame errors of the last completed round
+	size_t get_n_fe_estimate() const { return this->n_fe.load(std::memory_order_relaxed); }
+
+	// can be called by all the threads after each frame, 'local_stop' is voted in the next round
+	bool is_done(const bool local_stop = false)
+	{
+		if (this->done.load(std::memory_order_relaxed))
+			return true;
+
+		if (local_stop)
+			this->stop_vote.store(true, std::memory_order_relaxed);
+
+		bool expected = false;
+		if (!this->busy.compare_exchange_strong(expected, true, std::memory_order_acquire))
+			return false;
+
+		if (this->in_flight)
+		{
+			int completed = 0;
+			MPI_Test(&this->request, &completed, MPI_STATUS_IGNORE);
+			if (completed)
+			{
+				this->in_flight  = false;
+				this->next_round = Monitor_BFER_MPI::now() + this->period;
+				this->n_fe.store(this->recv[0], std::memory_order_relaxed);
+				if ((this->fe_limit && this->recv[0] >= this->fe_limit) || this->recv[1])
+					this->done.store(true, std::memory_order_relaxed);
+			}
+		}
+		else if (Monitor_BFER_MPI::now() >= this->next_round)
+		{
+			this->send[0] = this->counter.get_n_fe_estimate();
+			this->send[1] = this->stop_vote.load(std::memory_order_relaxed) ? 1 : 0;
+			MPI_Iallreduce(this->send, this->recv, 2, MPI_UINT64_T, MPI_SUM, this->comm, &this->request);
+			this->in_flight = true;
+		}
+
+		this->busy.store(false, std::memory_order_release);
+		return this->done.load(std::memory_order_relaxed);
+	}
+
+	/*
+	 * Has to be called by all the ranks when their threads are stopped: sums the exact counters of the ranks and adds
+	 * the ones of the other ranks in 'collector', then the reduction (and the reporters) have the cluster-wide values.
+	 * Returns true on all the ranks if 'local_over' is true on (at least) one rank (e.g. the user pressed Ctrl+c
+	 * twice): break the SNR loop on this value, never on a local one, or the other ranks wait for the next point.
+	 */
+	bool reduce(const bool local_over = false)
+	{
+		this->reduction.reduce();
+
+		const uint64_t local[4] = {(uint64_t)this->reduction.get_n_analyzed_fra(),
+		                           (uint64_t)this->reduction.get_n_fe(),
+		                           (uint64_t)this->reduction.get_n_be(),
+		                           local_over ? (uint64_t)1 : (uint64_t)0};
+		uint64_t global[4];
+		MPI_Allreduce(local, global, 4, MPI_UINT64_T, MPI_SUM, this->comm);
+
+		typename module::Monitor_BFER<B>::Attributes others;
+		others.n_analyzed_frames = global[0] - local[0];
+		others.n_fe              = global[1] - local[1];
+		others.n_be              = global[2] - local[2];
+		this->collector.collect(others);
+
+		this->reduction.reduce();
+		return global[3] != 0;
+	}
+
+	// has to be called when the threads are stopped (e.g. with 'Monitor_reduction::reset')
+	void reset()
+	{
+		this->in_flight  = false;
+		this->next_round = 0;
+		this->request    = MPI_REQUEST_NULL;
+		this->stop_vote.store(false, std::memory_order_relaxed);
+		this->done     .store(false, std::memory_order_relaxed);
+		this->n_fe     .store(0,     std::memory_order_relaxed);
+	}
+
+protected:
+	static int64_t now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+};
+}
+}
+
+#endif /* MONITOR_BFER_MPI_HPP_ */
@@ -0,0 +1,154 @@
+#ifndef MONITOR_BFER_COUNTER_HPP_
+#define MONITOR_BFER_COUNTER_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace tools
+{
+/*
+ * Low contention stop criterion for the 'Monitor_BFER' of many threads, to
+ * use instead of polling 'Monitor_reduction::is_done' on each frame.
+ *
+ * Each monitor (= each thread) counts its frame errors in its own padded slot
+ * (no shared cache line) and adds them to a global relaxed atomic estimate by
+ * steps of 'flush_step' errors: 'is_done' is a relaxed load in the common
+ * case. The estimate is a lower bound, so 'fe_limit' is honoured and the
+ * overshoot is bounded by 'n_monitors * (flush_step -1)' frame errors (+ the
+ * frames in progress). The exact reduction is lazy: 'reduction.is_done' (that
+ * also checks the frame limit) is called by only one thread every 'period',
+ * for the temporary reports.
+ */
+template <typename B = int>
+class Monitor_BFER_counter
+{
+public:
+	using Reduction = Monitor_reduction<module::Monitor_BFER<B>>;
+
+protected:
+	// 128 bytes: two slots are never in the same cache line, even if the vector is not aligned
+	struct Slot
+	{
+		uint64_t pending; // frame errors not yet added to the global estimate
+		uint64_t n_fe;    // all the frame errors of the monitor
+		char     padding[128 - 2 * sizeof(uint64_t)];
+	};
+
+	Reduction                &reduction;
+	const uint64_t            fe_limit;
+	const uint64_t            flush_step;
+	const int64_t             period; // in ns
+	std::vector<Slot>         slots;
+	std::atomic<uint64_t>     n_fe;       // global estimate of the frame errors
+	std::atomic<int64_t>      next_check; // date of the next exact check (in ns)
+	std::atomic<bool>         done;
+
+public:
+	/*
+	 * 'monitors':   the monitors of the threads (e.g. 'sequence.get_modules<module::Monitor_BFER<B>>()'),
+	 * 'fe_limit':   number of frame errors to simulate (0 = only the exact check of 'reduction'),
+	 * 'flush_step': 0 = fe_limit / (8 * n_monitors), the overshoot is then lower than 1/8 of 'fe_limit'.
+	 */
+	Monitor_BFER_counter(Reduction &reduction, const std::vector<module::Monitor_BFER<B>*> &monitors,
+	                     const size_t fe_limit,
+	                     const std::chrono::nanoseconds period = std::chrono::milliseconds(500),
+	                     const size_t flush_step = 0)
+	: reduction(reduction),
+	  fe_limit(fe_limit),
+	  flush_step(flush_step ? flush_step : std::max((size_t)1, fe_limit / (8 * std::max((size_t)1, monitors.size())))),
+	  period(period.count()),
+	  slots(monitors.size()),
+	  n_fe(0),
+	  next_check(0),
+	  done(false)
+	{
+		if (monitors.empty())
+			throw invalid_argument(__FILE__, __LINE__, __func__, "'monitors' can't be empty.");
+
+		this->reset();
+
+		// the callback is executed by the thread that owns the monitor: the slot is written by this thread only
+		for (size_t m = 0; m < monitors.size(); m++)
+			monitors[m]->record_callback_fe([this, m](unsigned, int) { this->add(m); });
+	}
+
+	Monitor_BFER_counter(const Monitor_BFER_counter&) = delete;
+	Monitor_BFER_counter& operator=(const Monitor_BFER_counter&) = delete;
+
+	// can be called by all the threads after each frame
+	bool is_done()
+	{
+		if (this->done.load(std::memory_order_relaxed))
+			return true;
+
+		if (this->fe_limit && this->n_fe.load(std::memory_order_relaxed) >= this->fe_limit)
+		{
+			this->done.store(true, std::memory_order_relaxed);
+			return true;
+		}
+
+		const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		                    std::chrono::steady_clock::now().time_since_epoch()).count();
+		auto next = this->next_check.load(std::memory_order_relaxed);
+		if (now >= next && this->next_check.compare_exchange_strong(next, now + this->period,
+		                                                           std::memory_order_relaxed))
+		{
+			// only one thread at a time: exact reduction and frame limit
+			if (this->reduction.is_done())
+			{
+				this->done.store(true, std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// lower bound of the number of frame errors
+	size_t get_n_fe_estimate() const { return this->n_fe.load(std::memory_order_relaxed); }
+
+	// maximum number of frame errors simulated beyond 'fe_limit' (without the frames in progress)
+	size_t get_max_overshoot() const { return this->slots.size() * (this->flush_step -1); }
+
+	// frame errors simulated before (e.g. restored from a checkpoint), has to be called when the threads are stopped
+	void add_fe(const size_t n_fe)
+	{
+		this->n_fe.fetch_add(n_fe, std::memory_order_relaxed);
+	}
+
+	// has to be called when the threads are stopped (e.g. with 'Monitor_reduction::reset')
+	void reset()
+	{
+		for (auto &s : this->slots)
+		{
+			s.pending = 0;
+			s.n_fe    = 0;
+		}
+		this->n_fe      .store(0,     std::memory_order_relaxed);
+		this->next_check.store(0,     std::memory_order_relaxed);
+		this->done      .store(false, std::memory_order_relaxed);
+	}
+
+protected:
+	void add(const size_t m)
+	{
+		auto &s = this->slots[m];
+		s.n_fe++;
+		if (++s.pending >= this->flush_step)
+		{
+			this->n_fe.fetch_add(s.pending, std::memory_order_relaxed);
+			s.pending = 0;
+		}
+	}
+};
+}
+}
+
+#endif /* MONITOR_BFER_COUNTER_HPP_ */
@@ -0,0 +1,217 @@
+#ifndef PERF_COUNTERS_HPP_
+#define PERF_COUNTERS_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace tools
+{
+/*
+ * Per task hardware performance counters (Linux 'perf_event'): cycles,
+ * instructions, L1D read misses, LLC misses and branch misses. The counters
+ * are read before and after each 'exec' of a task, for the calling thread
+ * only (user space only, allowed with 'perf_event_paranoid' <= 2).
+ *
+ * When the counters are disabled or not available (not Linux, virtual
+ * machine, permissions...), 'exec' simply executes the task.
+ */
+class Perf_counters
+{
+public:
+	enum class event : size_t { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, SIZE };
+
+protected:
+	static constexpr size_t n_events = (size_t)event::SIZE;
+
+	struct Task_counters
+	{
+		const module::Task *task;
+		size_t              n_calls;
+		uint64_t            values[n_events];
+	};
+
+	std::vector<int>           fds;    // one file descriptor per event (-1 = not available)
+	std::vector<size_t>        slots;  // position of each event in the group read (-1 = not available)
+	size_t                     n_open;
+	std::vector<Task_counters> counters;
+
+public:
+	explicit Perf_counters(const bool enable = true)
+	: fds(n_events, -1), slots(n_events, (size_t)-1), n_open(0)
+	{
+#if defined(__linux__)
+		if (!enable)
+			return;
+
+		const uint32_t types[n_events] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+		                                   PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+		const uint64_t confs[n_events] = { PERF_COUNT_HW_CPU_CYCLES,
+		                                   PERF_COUNT_HW_INSTRUCTIONS,
+		                                   PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ     <<  8) |
+		                                                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		                                   PERF_COUNT_HW_CACHE_MISSES,
+		                                   PERF_COUNT_HW_BRANCH_MISSES };
+
+		// all the events are in the group of the cycles: they are read at once
+		for (size_t e = 0; e < n_events; e++)
+		{
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size           = sizeof(attr);
+			attr.type           = types[e];
+			attr.config         = confs[e];
+			attr.disabled       = e == 0 ? 1 : 0;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv     = 1;
+			attr.read_format    = PERF_FORMAT_GROUP;
+
+			const int leader = this->fds[0];
+			if (e > 0 && leader == -1)
+				break;
+
+			this->fds[e] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+			if (this->fds[e] != -1)
+				this->slots[e] = this->n_open++;
+		}
+
+		if (this->fds[0] != -1)
+		{
+			ioctl(this->fds[0], PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP);
+			ioctl(this->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		}
+		else
+			std::clog << "# (WW) The hardware performance counters are not available." << std::endl;
+#else
+		(void)enable;
+#endif
+	}
+
+	Perf_counters(const Perf_counters&) = delete;
+	Perf_counters& operator=(const Perf_counters&) = delete;
+
+	virtual ~Perf_counters()
+	{
+#if defined(__linux__)
+		for (auto fd : this->fds)
+			if (fd != -1)
+				close(fd);
+#endif
+	}
+
+	bool is_available() const { return this->fds[0] != -1; }
+
+	bool is_available(const event e) const { return this->fds[(size_t)e] != -1; }
+
+	// execute the task 't' and accumulate the counters of this execution
+	int exec(module::Task &t)
+	{
+		if (!this->is_available())
+			return t.exec();
+
+		uint64_t start[n_events], stop[n_events];
+		this->read(start);
+		const auto status = t.exec();
+		this->read(stop);
+
+		auto &c = this->get(t);
+		c.n_calls++;
+		for (size_t e = 0; e < n_events; e++)
+			c.values[e] += stop[e] - start[e];
+
+		return status;
+	}
+
+	void reset() { this->counters.clear(); }
+
+	// display the counters per call of each task (same order as the first executions)
+	void show(std::ostream &stream = std::cout) const
+	{
+		if (!this->is_available() || this->counters.empty())
+			return;
+
+		const std::string names[n_events] = { "Cycles", "Instr.", "L1D miss", "LLC miss", "Br. miss" };
+
+		stream << "# -------------------------------------------||-------------------------------------------"
+		       << "--------------------------------"                                                           << std::endl;
+		stream << "#       Hardware counters (per call)         ||"                                           ;
+		for (size_t e = 0; e < n_events; e++)
+			stream << std::setw(12) << names[e] << " |";
+		stream << std::setw(8) << "IPC" << " |";
+		stream << std::setw(8) << "Calls"                                                                     << std::endl;
+		stream << "# -------------------------------------------||-------------------------------------------"
+		       << "--------------------------------"                                                           << std::endl;
+
+		for (auto &c : this->counters)
+		{
+			const auto &mod  = c.task->get_module();
+			const auto  name = (mod.get_custom_name().empty() ? mod.get_name() : mod.get_custom_name()) +
+			                   "::" + c.task->get_name();
+			stream << "# " << std::setw(42) << std::left << name.substr(0, 42) << std::right << " ||";
+			for (size_t e = 0; e < n_events; e++)
+				if (this->is_available((event)e))
+					stream << std::setw(12) << std::fixed << std::setprecision(1)
+					       << (double)c.values[e] / (double)c.n_calls << " |";
+				else
+					stream << std::setw(12) << "-" << " |";
+
+			const auto cycles = c.values[(size_t)event::CYCLES      ];
+			const auto instrs = c.values[(size_t)event::INSTRUCTIONS];
+			if (cycles && this->is_available(event::INSTRUCTIONS))
+				stream << std::setw(8) << std::setprecision(2) << (double)instrs / (double)cycles << " |";
+			else
+				stream << std::setw(8) << "-" << " |";
+			stream << std::setw(8) << c.n_calls << std::endl;
+		}
+		stream << "#" << std::endl;
+	}
+
+protected:
+	void read(uint64_t values[n_events]) const
+	{
+		std::fill(values, values + n_events, 0);
+#if defined(__linux__)
+		uint64_t buffer[1 + n_events]; // { nr, values[nr] }
+		if (::read(this->fds[0], buffer, sizeof(buffer)) <= 0)
+			return;
+		for (size_t e = 0; e < n_events; e++)
+			if (this->slots[e] != (size_t)-1 && this->slots[e] < buffer[0])
+				values[e] = buffer[1 + this->slots[e]];
+#endif
+	}
+
+	Task_counters& get(const module::Task &t)
+	{
+		auto it = std::find_if(this->counters.begin(), this->counters.end(),
+		                       [&t](const Task_counters &c) { return c.task == &t; });
+		if (it != this->counters.end())
+			return *it;
+
+		Task_counters c;
+		c.task    = &t;
+		c.n_calls = 0;
+		std::fill(c.values, c.values + n_events, 0);
+		this->counters.push_back(c);
+		return this->counters.back();
+	}
+};
+}
+}
+
+#endif /* PERF_COUNTERS_HPP_ */
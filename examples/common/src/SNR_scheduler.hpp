@@ -0,0 +1,105 @@
+#ifndef SNR_SCHEDULER_HPP_
+#define SNR_SCHEDULER_HPP_
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace aff3ct
+{
+namespace tools
+{
+/*
+ * Distributes the threads over the SNR points of a sweep simulated in
+ * parallel. The threads simulate a chunk of frames on a point and then call
+ * 'next': they stay on their point unless another unfinished point has
+ * strictly fewer threads, so the threads of the finished (low SNR) points are
+ * stolen by the expensive ones (high SNR) until the end of the sweep.
+ *
+ * 'next' is called once per chunk: a mutex is enough.
+ */
+class SNR_scheduler
+{
+protected:
+	struct Point
+	{
+		size_t n_workers; // number of threads currently on the point
+		bool   done;      // the stop criterion of the point is reached
+		bool   reported;  // the final report of the point has been displayed
+	};
+
+	std::vector<Point> points;
+	std::mutex         mtx;
+
+public:
+	explicit SNR_scheduler(const size_t n_points)
+	: points(n_points, Point{0, false, false})
+	{
+	}
+
+	size_t get_n_points() const { return this->points.size(); }
+
+	// the point 'k' is over: no more thread will be given to it
+	void finish(const int k)
+	{
+		std::lock_guard<std::mutex> lock(this->mtx);
+		this->points[k].done = true;
+	}
+
+	/*
+	 * Releases the point 'previous' (-1 for the first call) and returns the point to simulate next (-1 if all the
+	 * points are done). 'report' is set to true when the calling thread was the last one on a finished 'previous'
+	 * point: its monitors are not modified anymore and it can be reported.
+	 */
+	int next(const int previous, bool &report)
+	{
+		std::lock_guard<std::mutex> lock(this->mtx);
+
+		report = false;
+		if (previous >= 0)
+		{
+			auto &prev = this->points[previous];
+			prev.n_workers--;
+			if (prev.done && prev.n_workers == 0 && !prev.reported)
+				prev.reported = report = true;
+		}
+
+		// the fewest threads first, in case of equality: the current point, then the highest SNR
+		int best = (previous >= 0 && !this->points[previous].done) ? previous : -1;
+		for (int k = (int)this->points.size() -1; k >= 0; k--)
+			if (!this->points[k].done && (best == -1 || this->points[k].n_workers < this->points[best].n_workers))
+				best = k;
+
+		if (best >= 0)
+			this->points[best].n_workers++;
+		return best;
+	}
+
+	/*
+	 * Ctrl+c: the points in progress (= with at least one thread) are over, as if their stop criterion was reached,
+	 * the other points are simulated next. 'take' is called under the lock and returns true if the calling thread is
+	 * the first one to handle this interrupt (e.g. it resets the interrupt of the terminal), so the points that the
+	 * threads start after the interrupt are not skipped.
+	 */
+	void interrupt(const std::function<bool()> &take)
+	{
+		std::lock_guard<std::mutex> lock(this->mtx);
+		if (take())
+			for (auto &pt : this->points)
+				if (pt.n_workers)
+					pt.done = true;
+	}
+
+	// returns true if the point 'k' has not been reported yet (and marks it as reported)
+	bool set_reported(const int k)
+	{
+		std::lock_guard<std::mutex> lock(this->mtx);
+		const bool first = !this->points[k].reported;
+		this->points[k].reported = true;
+		return first;
+	}
+};
+}
+}
+
+#endif /* SNR_SCHEDULER_HPP_ */
@@ -0,0 +1,80 @@
+#ifndef SOCKET_ARENA_HPP_
+#define SOCKET_ARENA_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace tools
+{
+/*
+ * Contiguous allocation of the output sockets of a chain of tasks, instead of
+ * one buffer per socket with 'Task::set_autoalloc(true)'. The buffers are laid
+ * out in the execution order of the tasks, each one aligned on 'alignment'
+ * bytes, so the working set of the chain is a single block of memory (that
+ * fits in the L2 cache for short frames). The block is allocated and touched
+ * by the calling thread: build the arena in the thread that executes the
+ * chain (first-touch allocation on its NUMA node).
+ *
+ * The arena has to be built before the binding of the input sockets, which
+ * take the addresses of the output sockets, and has to outlive the tasks.
+ */
+class Socket_arena
+{
+protected:
+	const size_t               alignment;
+	std::unique_ptr<uint8_t[]> buffer;
+	size_t                     n_bytes;
+	size_t                     n_sockets;
+
+public:
+	// 'tasks' in execution order: their automatic allocation is disabled and their output sockets are bound to the arena
+	explicit Socket_arena(const std::vector<module::Task*> &tasks, const size_t alignment = 64)
+	: alignment(alignment), n_bytes(0), n_sockets(0)
+	{
+		if (alignment == 0 || (alignment & (alignment -1)))
+			throw invalid_argument(__FILE__, __LINE__, __func__, "'alignment' has to be a power of 2.");
+
+		std::vector<std::pair<module::Socket*,size_t>> offsets;
+		for (auto tsk : tasks)
+		{
+			tsk->set_autoalloc(false);
+			for (auto &sck : tsk->sockets)
+				if (tsk->get_socket_type(*sck) == module::socket_t::SOUT && sck->get_name() != "status")
+				{
+					offsets.push_back(std::make_pair(sck.get(), this->n_bytes));
+					this->n_bytes += this->align(sck->get_databytes());
+				}
+		}
+
+		this->n_sockets = offsets.size();
+		this->buffer.reset(new uint8_t[this->n_bytes + this->alignment]);
+		auto base = this->buffer.get() + this->align((size_t)(uintptr_t)this->buffer.get()) -
+		            (size_t)(uintptr_t)this->buffer.get();
+		std::fill(base, base + this->n_bytes, 0); // first touch
+
+		for (auto &o : offsets)
+			o.first->bind(static_cast<void*>(base + o.second));
+	}
+
+	Socket_arena(const Socket_arena&) = delete;
+	Socket_arena& operator=(const Socket_arena&) = delete;
+
+	size_t get_n_bytes  () const { return this->n_bytes;   }
+	size_t get_n_sockets() const { return this->n_sockets; }
+
+protected:
+	size_t align(const size_t n) const
+	{
+		return (n + this->alignment -1) & ~(this->alignment -1);
+	}
+};
+}
+}
+
+#endif /* SOCKET_ARENA_HPP_ */
@@ -0,0 +1,217 @@
+#ifndef STATS_EXPORT_HPP_
+#define STATS_EXPORT_HPP_
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace tools
+{
+/*
+ * Machine-readable (JSON and CSV) export of the task statistics, the same data
+ * as 'Stats::show': the statistics of the clones of a task (same module type
+ * and same task) are merged in one entry.
+ *
+ * JSON: { "tasks": [ { "stage", "module", "task", "n_calls", "n_frames",
+ *                      "time_total_ns", "time_min_ns", "time_max_ns",
+ *                      "time_avg_ns", "throughput_fps",
+ *                      "sockets": [ { "name", "bytes_per_frame", "bytes_total" } ] } ] }
+ * CSV:  one line per task (the socket volumes are summed in 'bytes_total').
+ *
+ * The times in ns are integers, the averages and the throughputs are written
+ * with 17 significant digits (exact doubles, to diff the exports).
+ */
+class Stats_export
+{
+protected:
+	struct Socket_stats
+	{
+		std::string name;
+		size_t      bytes_per_frame;
+		size_t      bytes_total;
+	};
+
+	struct Task_stats
+	{
+		size_t                    stage;
+		std::string               module;
+		std::string               task;
+		size_t                    n_calls;
+		size_t                    n_frames;   // number of frames processed
+		uint64_t                  total_ns;
+		uint64_t                  min_ns;
+		uint64_t                  max_ns;
+		std::vector<Socket_stats> sockets;
+	};
+
+	std::vector<Task_stats> entries;
+
+public:
+	Stats_export() = default;
+
+	// e.g. 'sequence.get_modules_per_types()'
+	template <class M>
+	void add_modules(const std::vector<std::vector<M*>> &modules_per_types, const size_t stage = 0)
+	{
+		for (auto &mods : modules_per_types)
+		{
+			if (mods.empty()) continue;
+			for (size_t t = 0; t < mods[0]->tasks.size(); t++)
+			{
+				std::vector<const module::Task*> clones;
+				for (auto &m : mods)
+					clones.push_back(m->tasks[t].get());
+				this->add(clones, stage);
+			}
+		}
+	}
+
+	// e.g. 'pipeline.get_stages()[s]->get_tasks_per_types()'
+	template <class T>
+	void add_tasks(const std::vector<std::vector<T*>> &tasks_per_types, const size_t stage = 0)
+	{
+		for (auto &tsks : tasks_per_types)
+			this->add(std::vector<const module::Task*>(tsks.begin(), tsks.end()), stage);
+	}
+
+	void clear() { this->entries.clear(); }
+
+	void write_json(std::ostream &os) const
+	{
+		const auto precision = os.precision(17);
+		os << "{" << std::endl << "  \"tasks\": [";
+		for (size_t e = 0; e < this->entries.size(); e++)
+		{
+			const auto &s = this->entries[e];
+			os << (e ? "," : "") << std::endl
+			   << "    { \"stage\": "          << s.stage
+			   << ", \"module\": "             << Stats_export::quote(s.module)
+			   << ", \"task\": "               << Stats_export::quote(s.task)
+			   << ", \"n_calls\": "            << s.n_calls
+			   << ", \"n_frames\": "           << s.n_frames
+			   << ", \"time_total_ns\": "      << s.total_ns
+			   << ", \"time_min_ns\": "        << s.min_ns
+			   << ", \"time_max_ns\": "        << s.max_ns
+			   << ", \"time_avg_ns\": "        << Stats_export::avg_ns(s)
+			   << ", \"throughput_fps\": "     << Stats_export::throughput(s)
+			   << ", \"sockets\": [";
+			for (size_t k = 0; k < s.sockets.size(); k++)
+				os << (k ? ", " : "") << "{ \"name\": " << Stats_export::quote(s.sockets[k].name)
+				   << ", \"bytes_per_frame\": " << s.sockets[k].bytes_per_frame
+				   << ", \"bytes_total\": " << s.sockets[k].bytes_total << " }";
+			os << "] }";
+		}
+		os << std::endl << "  ]" << std::endl << "}" << std::endl;
+		os.precision(precision);
+	}
+
+	void write_csv(std::ostream &os) const
+	{
+		const auto precision = os.precision(17);
+		os << "stage,module,task,n_calls,n_frames,time_total_ns,time_min_ns,time_max_ns,time_avg_ns,"
+		   << "throughput_fps,bytes_total" << std::endl;
+		for (auto &s : this->entries)
+		{
+			size_t bytes_total = 0;
+			for (auto &sck : s.sockets)
+				bytes_total += sck.bytes_total;
+			os << s.stage << "," << Stats_export::quote(s.module) << "," << Stats_export::quote(s.task) << ","
+			   << s.n_calls << "," << s.n_frames << "," << s.total_ns << "," << s.min_ns << "," << s.max_ns << ","
+			   << Stats_export::avg_ns(s) << "," << Stats_export::throughput(s) << "," << bytes_total << std::endl;
+		}
+		os.precision(precision);
+	}
+
+	// the format is given by the extension of 'path' (".json" or ".csv")
+	void save(const std::string &path) const
+	{
+		const auto ext = path.substr(path.find_last_of('.') + 1);
+		std::ofstream f(path);
+		if (!f.is_open())
+			throw std::runtime_error("Can't open the '" + path + "' file.");
+		if (ext == "json")
+			this->write_json(f);
+		else if (ext == "csv")
+			this->write_csv(f);
+		else
+			throw std::invalid_argument("Unknown stats export format ('path' = " + path + ").");
+	}
+
+protected:
+	void add(const std::vector<const module::Task*> &clones, const size_t stage)
+	{
+		if (clones.empty()) return;
+
+		Task_stats s;
+		s.stage    = stage;
+		s.module   = clones[0]->get_module().get_custom_name().empty() ? clones[0]->get_module().get_name()
+		                                                               : clones[0]->get_module().get_custom_name();
+		s.task     = clones[0]->get_name();
+		s.n_calls  = 0;
+		s.n_frames = 0;
+		s.total_ns = 0;
+		s.min_ns   = 0;
+		s.max_ns   = 0;
+		for (auto &sck : clones[0]->sockets)
+			s.sockets.push_back({sck->get_name(), 0, 0});
+
+		for (auto &t : clones)
+		{
+			const auto n_calls = t->get_n_calls();
+			if (n_calls == 0) continue;
+
+			const auto n_frames = t->get_module().get_n_frames();
+			const auto min_ns   = (uint64_t)t->get_duration_min().count();
+			s.min_ns    = s.n_calls ? std::min(s.min_ns, min_ns) : min_ns;
+			s.max_ns    = std::max(s.max_ns, (uint64_t)t->get_duration_max().count());
+			s.total_ns += (uint64_t)t->get_duration_total().count();
+			s.n_calls  += n_calls;
+			s.n_frames += n_calls * n_frames;
+			for (size_t k = 0; k < s.sockets.size() && k < t->sockets.size(); k++)
+			{
+				const auto bytes = t->sockets[k]->get_databytes();
+				s.sockets[k].bytes_per_frame  = n_frames ? bytes / n_frames : bytes;
+				s.sockets[k].bytes_total     += bytes * n_calls;
+			}
+		}
+
+		if (s.n_calls)
+			this->entries.push_back(s);
+	}
+
+	static double avg_ns(const Task_stats &s)
+	{
+		return s.n_calls ? (double)s.total_ns / (double)s.n_calls : 0.;
+	}
+
+	static double throughput(const Task_stats &s)
+	{
+		return s.total_ns ? (double)s.n_frames * 1e9 / (double)s.total_ns : 0.;
+	}
+
+	static std::string quote(const std::string &str)
+	{
+		std::stringstream ss;
+		ss << '"';
+		for (auto c : str)
+		{
+			if (c == '"' || c == '\\') ss << '\\';
+			ss << c;
+		}
+		ss << '"';
+		return ss.str();
+	}
+};
+}
+}
+
+#endif /* STATS_EXPORT_HPP_ */
@@ -0,0 +1,153 @@
+#ifndef THREAD_PLACEMENT_HPP_
+#define THREAD_PLACEMENT_HPP_
+
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <set>
+
+#if defined(__linux__)
+#include <fstream>
+#endif
+
+namespace aff3ct
+{
+namespace tools
+{
+/*
+ * Computes the processing unit ids (PUIDs, in the logical order of hwloc: the PUs
+ * of a socket are contiguous) given to the 'thread_pinning' / 'puids' parameters
+ * of 'Sequence' and 'Pipeline'. The threads are pinned before they clone their
+ * modules, so the clones are first-touched on the NUMA node of their thread.
+ *
+ * Policies:
+ *   - "NONE":         no pinning,
+ *   - "COMPACT":      fill the PUs in order (socket 0 first),
+ *   - "SCATTER":      round-robin over the sockets,
+ *   - "STAGE_SOCKET": pipeline stage 's' on socket 's % n_sockets', compact in
+ *                     the socket after the threads of the previous stages on
+ *                     the same socket (two threads share a PU only when the
+ *                     socket is full), a sequence behaves as "COMPACT",
+ *   - "<id>,<id>,...": explicit list of PUIDs, the threads take them in order
+ *                     (and wrap around).
+ */
+class Thread_placement
+{
+protected:
+	std::string         policy;
+	std::vector<size_t> user_puids;
+	size_t              n_pus;
+	size_t              n_sockets;
+
+public:
+	explicit Thread_placement(const std::string &policy = "NONE",
+	                          const size_t n_pus = std::thread::hardware_concurrency(),
+	                          const size_t n_sockets = Thread_placement::detect_n_sockets())
+	: policy(policy), n_pus(std::max((size_t)1, n_pus)), n_sockets(std::max((size_t)1, n_sockets))
+	{
+		if (policy != "NONE" && policy != "COMPACT" && policy != "SCATTER" && policy != "STAGE_SOCKET")
+		{
+			std::stringstream ss(policy);
+			std::string id;
+			while (std::getline(ss, id, ','))
+			{
+				size_t pos = 0;
+				unsigned long puid = 0;
+				try { puid = std::stoul(id, &pos); } catch (const std::logic_error&) { pos = 0; }
+				if (pos == 0 || pos != id.size())
+					throw std::invalid_argument("Unknown thread placement policy ('policy' = " + policy + ").");
+				if (puid >= this->n_pus)
+					throw std::invalid_argument("'puid' has to be smaller than 'n_pus' ('puid' = " +
+					                            std::to_string(puid) + ", 'n_pus' = " +
+					                            std::to_string(this->n_pus) + ").");
+				this->user_puids.push_back(puid);
+			}
+			if (this->user_puids.empty())
+				throw std::invalid_argument("Unknown thread placement policy ('policy' = " + policy + ").");
+			this->policy = "LIST";
+		}
+		// the sockets are assumed to have the same number of PUs
+		if (this->n_pus % this->n_sockets)
+			this->n_sockets = 1;
+	}
+
+	bool is_pinning() const { return this->policy != "NONE"; }
+
+	size_t get_n_sockets() const { return this->n_sockets; }
+
+	// PUIDs of the threads of a 'Sequence'
+	std::vector<size_t> get_puids(const size_t n_threads) const
+	{
+		return this->get_puids(n_threads, 0, 0, 0, false);
+	}
+
+	// PUIDs of the threads of each stage of a 'Pipeline'
+	std::vector<std::vector<size_t>> get_puids(const std::vector<size_t> &n_threads_per_stage) const
+	{
+		std::vector<std::vector<size_t>> puids;
+		std::vector<size_t> n_socket_threads(this->n_sockets, 0); // threads already placed on each socket
+		size_t offset = 0;
+		for (size_t s = 0; s < n_threads_per_stage.size(); s++)
+		{
+			auto &socket_offset = n_socket_threads[s % this->n_sockets];
+			puids.push_back(this->get_puids(n_threads_per_stage[s], s, offset, socket_offset, true));
+			offset        += n_threads_per_stage[s];
+			socket_offset += n_threads_per_stage[s];
+		}
+		return puids;
+	}
+
+	// pinning flags of each stage of a 'Pipeline'
+	std::vector<bool> get_pinning(const size_t n_stages) const
+	{
+		return std::vector<bool>(n_stages, this->is_pinning());
+	}
+
+	static size_t detect_n_sockets()
+	{
+		std::set<std::string> packages;
+#if defined(__linux__)
+		for (size_t c = 0; c < std::thread::hardware_concurrency(); c++)
+		{
+			std::ifstream f("/sys/devices/system/cpu/cpu" + std::to_string(c) + "/topology/physical_package_id");
+			std::string id;
+			if (f >> id)
+				packages.insert(id);
+		}
+#endif
+		return std::max((size_t)1, packages.size());
+	}
+
+protected:
+	// 'offset' is the number of threads of the previous stages and 'socket_offset' the number of these threads on the
+	// socket of the stage, "STAGE_SOCKET" is "COMPACT" out of a pipeline
+	std::vector<size_t> get_puids(const size_t n_threads, const size_t stage_id, const size_t offset,
+	                              const size_t socket_offset, const bool pipeline) const
+	{
+		std::vector<size_t> puids;
+		if (!this->is_pinning())
+			return puids;
+
+		const auto pus_per_socket = this->n_pus / this->n_sockets;
+		for (size_t t = 0; t < n_threads; t++)
+		{
+			const auto i = offset + t;
+			if (this->policy == "LIST")
+				puids.push_back(this->user_puids[i % this->user_puids.size()]);
+			else if (this->policy == "COMPACT" || (this->policy == "STAGE_SOCKET" && !pipeline))
+				puids.push_back(i % this->n_pus);
+			else if (this->policy == "SCATTER")
+				puids.push_back(((i % this->n_sockets) * pus_per_socket + i / this->n_sockets) % this->n_pus);
+			else // "STAGE_SOCKET"
+				puids.push_back((stage_id % this->n_sockets) * pus_per_socket + (socket_offset + t) % pus_per_socket);
+		}
+		return puids;
+	}
+};
+}
+}
+
+#endif /* THREAD_PLACEMENT_HPP_ */
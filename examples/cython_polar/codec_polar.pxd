@@ -1,9 +1,45 @@
 from libcpp.vector cimport vector
 from libcpp cimport bool
+from libcpp.string cimport string
 
 cdef extern from "src/codec_polar.hpp":
-    vector[bool] generate_frozen_bits(const int, const int, const float)
+    cdef struct BERCounters:
+        long long n_be
+        long long n_fe
+        long long n_fra
+        double ber
+        double fer
+
+    cdef cppclass PolarCodec:
+        PolarCodec(const int, const int, const vector[bool] &, const string &, const int, const string &) except +
+        int get_k() const
+        int get_n() const
+        int get_crc_size() const
+        int get_n_frames_per_call() const
+        int get_n_threads() const
+        void set_n_threads(int) except +
+        const string &get_decoder_type() const
+        const vector[bool] &get_frozen_bits() const
+        void set_frozen_bits(const vector[bool] &) except +
+        const vector[int] &encode(const vector[int] &) except +
+        const vector[int] &decode(const vector[float] &) except +
+        void encode_batch(const int *, int *, const int) nogil except +
+        void decode_batch(const float *, int *, const int) nogil except +
+        BERCounters simulate_ber(const float, const int, const int) nogil except +
+
+    cdef cppclass FrozenBitsCache:
+        vector[bool] get(const int, const int, const float, const string &) except +
+        size_t size() const
+        void clear()
+        void save(const string &) except +
+        size_t load(const string &) except +
+
+    FrozenBitsCache &frozen_bits_cache()
+    vector[bool] generate_frozen_bits(const int, const int, const float, const string &) except +
     vector[int] polar_encode(const int, const int, const vector[bool] &, const vector[int] &)
     vector[vector[int]] polar_encode_multiple(const int, const int, const vector[bool] &, const vector[vector[int]] &)
     vector[int] polar_decode(const int, const int, const vector[bool] &, const vector[float] &)
     vector[vector[int]] polar_decode_multiple(const int, const int, const vector[bool] &, const vector[vector[float]] &)
+    void polar_encode_batch(const int, const int, const vector[bool] &, const int *, int *, const int, const string &, const int, const string &) nogil except +
+    void polar_decode_batch(const int, const int, const vector[bool] &, const float *, int *, const int, const string &, const int, const string &, const int) nogil except +
+    BERCounters simulate_ber(const int, const int, const float, const int, const int, const string &, const int, const string &, const int) nogil except +
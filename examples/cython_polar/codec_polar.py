@@ -1,3 +1,4 @@
+import os
 import numpy as np
 import matplotlib.pyplot as plt
 from codec_polar import *
@@ -11,32 +12,30 @@ if __name__ == "__main__":
 
     all_data = []
 
+    # reuse the frozen bits computed by the previous runs
+    cache_path = "frozen_bits_cache.txt"
+    if os.path.isfile(cache_path):
+        py_frozen_bits_cache_load(cache_path)
+
     for i, k in enumerate([256, 300, 350, 400, 425, 450, 475, 500]):
         ber_curve = []
-        for snr in snr_range:
-            frozen_bits = py_generate_frozen_bits(k, n, snr)
-
-            info_bits = np.random.randint(2, size=(n_frame, k))
-            encoded = np.array(py_polar_encode_multiple(k, n, frozen_bits, info_bits))
-
-            power = np.var(encoded)
-            noise_power = power * 10 ** (-snr / 10.0)
-            received = (
-                -encoded * 2 + 1 + np.sqrt(noise_power) * np.random.randn(n_frame, n)
-            )
+        codec = PyPolarCodec(k, n, py_generate_frozen_bits(k, n, snr_range[0]), n_threads=0)
+        for j, snr in enumerate(snr_range):
+            codec.set_frozen_bits(py_generate_frozen_bits(k, n, snr))
 
-            decoded = np.array(py_polar_decode_multiple(k, n, frozen_bits, received))
-
-            ber = np.sum(info_bits != decoded) / info_bits.size
+            # source, BPSK, AWGN channel and decoding run in the extension
+            ber = codec.simulate_ber(snr, n_frame, seed=j)["ber"]
             ber_curve.append(ber)
 
-            print(f"K={k}, SNR={snr:.2f}dB, BER={ber:.2e}")
+            print(f"K={k}, Eb/N0={snr:.2f}dB, BER={ber:.2e}")
 
         plt.plot(snr_range, ber_curve, label=f"R={k * 1.0 / n:.2f}", marker=marker[i])
         all_data.append({k: ber_curve})
 
+    py_frozen_bits_cache_save(cache_path)
+
     plt.title(f"Polar Performance using Python, N = {n}")
-    plt.xlabel("SNR [dB]")
+    plt.xlabel("Eb/N0 [dB]")
     plt.ylabel("BER")
     plt.ylim([1e-4, 0.52])
     plt.yscale("log")
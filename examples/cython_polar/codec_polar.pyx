@@ -1,9 +1,13 @@
 cimport cython
 
 
-def py_generate_frozen_bits(k, n, snr_max):
+def py_generate_frozen_bits(k, n, snr_max, generator="GA_Arikan"):
     """Generate Frozen Bits following Arikan's method
 
+    The result is memoized in a process-wide cache keyed by (k, n, SNR rounded
+    to 0.001 dB, generator), see `py_frozen_bits_cache_save` and
+    `py_frozen_bits_cache_load` to share it between runs.
+
     Parameters
     ----------
     k : int
@@ -12,13 +16,47 @@ def py_generate_frozen_bits(k, n, snr_max):
         Codeword length
     snr_max : float
         estimated SNR in dB
+    generator : str
+        Frozen bits generator type: "GA_Arikan" or "GA"
 
     Returns
     -------
     list of booleans, size (n,)
         The frozen bits
     """
-    return generate_frozen_bits(k, n, snr_max)
+    return generate_frozen_bits(k, n, snr_max, generator.encode())
+
+
+def py_frozen_bits_cache_save(path):
+    """Save the frozen bits cache to a text file
+
+    Parameters
+    ----------
+    path : str
+        The cache file path (written atomically)
+    """
+    frozen_bits_cache().save(path.encode())
+
+
+def py_frozen_bits_cache_load(path):
+    """Load entries into the frozen bits cache from a text file
+
+    Parameters
+    ----------
+    path : str
+        The cache file path
+
+    Returns
+    -------
+    int
+        The number of entries read from the file
+    """
+    return frozen_bits_cache().load(path.encode())
+
+
+def py_frozen_bits_cache_clear():
+    """Remove all the entries of the frozen bits cache"""
+    frozen_bits_cache().clear()
 
 
 def py_polar_encode(k, n, frozen_bits, info_bits):
@@ -109,3 +147,292 @@ def py_polar_decode_multiple(k, n, frozen_bits, received):
     """
     assert received.shape[1] > 0
     return polar_decode_multiple(k, n, frozen_bits, received)
+
+
+def py_polar_encode_batch(k, n, frozen_bits, const int[:, ::1] info_bits, int[:, ::1] encoded,
+                          decoder_type="SC_NAIVE", list_size=8, crc_poly="8-DVB-S2"):
+    """Polar encode for multiple frames, in place and without the GIL
+
+    Parameters
+    ----------
+    k : int
+        The length of information bits in a codeword
+    n : int
+        Codeword length
+    frozen_bits : list of booleans, size (n,)
+        The frozen bits, maybe generated from `py_generate_frozen_bits`
+    info_bits : C-contiguous ndarray of int32 (np.intc), shape (n_frame, k)
+        The information bits pending to be encoded
+    encoded : C-contiguous ndarray of int32 (np.intc), shape (n_frame, n)
+        The output array, filled with the polar encoded bits
+    decoder_type : str
+        The decoder type the frames will be decoded with (it selects a
+        systematic or a non-systematic encoding), see `PyPolarCodec`
+    list_size : int
+        The list size of the "SCL" and "CASCL" decoders
+    crc_poly : str
+        The CRC polynomial of the "CASCL" decoder (appended by the encoder)
+    """
+    assert info_bits.shape[1] == k and encoded.shape[1] == n
+    assert info_bits.shape[0] == encoded.shape[0]
+    cdef vector[bool] c_frozen_bits = frozen_bits
+    cdef int c_k = k, c_n = n, n_frame = info_bits.shape[0], c_list_size = list_size
+    cdef string c_decoder_type = decoder_type.encode(), c_crc_poly = crc_poly.encode()
+    if n_frame == 0:
+        return
+    with nogil:
+        polar_encode_batch(c_k, c_n, c_frozen_bits, &info_bits[0, 0], &encoded[0, 0], n_frame,
+                           c_decoder_type, c_list_size, c_crc_poly)
+
+
+def py_polar_decode_batch(k, n, frozen_bits, const float[:, ::1] received, int[:, ::1] decoded,
+                          decoder_type="SC_NAIVE", list_size=8, crc_poly="8-DVB-S2", n_threads=1):
+    """Polar decode for multiple frames, in place and without the GIL
+
+    Parameters
+    ----------
+    k : int
+        The length of information bits in a codeword
+    n : int
+        Codeword length
+    frozen_bits : list of booleans, size (n,)
+        The frozen bits, maybe generated from `py_generate_frozen_bits`
+    received : C-contiguous ndarray of float32, shape (n_frame, n)
+        The received log-likelihood ratios (LLRs)
+    decoded : C-contiguous ndarray of int32 (np.intc), shape (n_frame, k)
+        The output array, filled with the polar decoded bits
+    decoder_type : str
+        The decoder type: "SC_NAIVE", "SC_FAST", "SC_FAST_INTER", "SCL" or
+        "CASCL", see `PyPolarCodec`
+    list_size : int
+        The list size of the "SCL" and "CASCL" decoders
+    crc_poly : str
+        The CRC polynomial of the "CASCL" decoder
+    n_threads : int
+        The number of decoding threads (0 = the number of hardware threads)
+    """
+    assert received.shape[1] == n and decoded.shape[1] == k
+    assert received.shape[0] == decoded.shape[0]
+    cdef vector[bool] c_frozen_bits = frozen_bits
+    cdef int c_k = k, c_n = n, n_frame = received.shape[0], c_list_size = list_size
+    cdef int c_n_threads = n_threads
+    cdef string c_decoder_type = decoder_type.encode(), c_crc_poly = crc_poly.encode()
+    if n_frame == 0:
+        return
+    with nogil:
+        polar_decode_batch(c_k, c_n, c_frozen_bits, &received[0, 0], &decoded[0, 0], n_frame,
+                           c_decoder_type, c_list_size, c_crc_poly, c_n_threads)
+
+
+def py_simulate_ber(k, n, snr, n_frame, seed=0, decoder_type="SC_NAIVE", list_size=8, crc_poly="8-DVB-S2",
+                    n_threads=1):
+    """BER/FER simulation over a BPSK/AWGN channel, entirely in native memory
+
+    Parameters
+    ----------
+    k : int
+        The length of information bits in a codeword
+    n : int
+        Codeword length
+    snr : float
+        Eb/N0 in dB (the frozen bits are generated for this SNR)
+    n_frame : int
+        The number of frames to simulate
+    seed : int
+        The seed of the source and of the channel
+    decoder_type : str
+        The decoder type, see `PyPolarCodec`
+    list_size : int
+        The list size of the "SCL" and "CASCL" decoders
+    crc_poly : str
+        The CRC polynomial of the "CASCL" decoder
+    n_threads : int
+        The number of decoding threads (0 = the number of hardware threads)
+
+    Returns
+    -------
+    dict
+        The counters: "n_be", "n_fe", "n_fra", "ber" and "fer"
+    """
+    cdef int c_k = k, c_n = n, c_n_frame = n_frame, c_seed = seed
+    cdef int c_list_size = list_size, c_n_threads = n_threads
+    cdef float c_snr = snr
+    cdef string c_decoder_type = decoder_type.encode(), c_crc_poly = crc_poly.encode()
+    cdef BERCounters counters
+    with nogil:
+        counters = simulate_ber(c_k, c_n, c_snr, c_n_frame, c_seed, c_decoder_type, c_list_size, c_crc_poly,
+                                c_n_threads)
+    return counters
+
+
+cdef class PyPolarCodec:
+    """Stateful polar codec: the encoder and the decoder are built once and reused
+
+    Parameters
+    ----------
+    k : int
+        The length of information bits in a codeword
+    n : int
+        Codeword length
+    frozen_bits : list of booleans, size (n,)
+        The frozen bits, maybe generated from `py_generate_frozen_bits`
+        (for "CASCL", generated for `k + crc_size` information bits)
+    decoder_type : str
+        "SC_NAIVE" (default), "SC_FAST", "SC_FAST_INTER" (one frame per SIMD
+        lane, best with `decode_batch`), "SCL" or "CASCL" (CRC-aided SCL, the
+        CRC is added by `encode`). All but "SC_NAIVE" use a systematic
+        encoding: decode with the codec that encoded.
+    list_size : int
+        The list size of the "SCL" and "CASCL" decoders
+    crc_poly : str
+        The CRC polynomial of the "CASCL" decoder
+    n_threads : int
+        The number of threads of `encode_batch` and `decode_batch` (0 = the
+        number of hardware threads), each thread owns a clone of the encoder
+        and of the decoder and stays parked between the batches
+    """
+    cdef PolarCodec *c_codec
+
+    def __cinit__(self, k, n, frozen_bits, decoder_type="SC_NAIVE", list_size=8, crc_poly="8-DVB-S2",
+                  n_threads=1):
+        self.c_codec = new PolarCodec(k, n, frozen_bits, decoder_type.encode(), list_size, crc_poly.encode())
+        self.c_codec.set_n_threads(n_threads)
+
+    def __dealloc__(self):
+        del self.c_codec
+
+    @property
+    def k(self):
+        return self.c_codec.get_k()
+
+    @property
+    def n(self):
+        return self.c_codec.get_n()
+
+    @property
+    def crc_size(self):
+        return self.c_codec.get_crc_size()
+
+    @property
+    def decoder_type(self):
+        return self.c_codec.get_decoder_type().decode()
+
+    @property
+    def n_frames_per_call(self):
+        return self.c_codec.get_n_frames_per_call()
+
+    @property
+    def n_threads(self):
+        return self.c_codec.get_n_threads()
+
+    @n_threads.setter
+    def n_threads(self, n_threads):
+        self.c_codec.set_n_threads(n_threads)
+
+    @property
+    def frozen_bits(self):
+        return self.c_codec.get_frozen_bits()
+
+    def set_frozen_bits(self, frozen_bits):
+        """Replace the frozen bits in place (no reallocation of the codec)
+
+        Parameters
+        ----------
+        frozen_bits : list of booleans, size (n,)
+            The new frozen bits
+        """
+        self.c_codec.set_frozen_bits(frozen_bits)
+
+    def encode(self, info_bits):
+        """Polar encode a single frame
+
+        Parameters
+        ----------
+        info_bits : list (or ndarray) of information bits of shape (k,)
+
+        Returns
+        -------
+        list of encoded bits, size (n,)
+        """
+        return self.c_codec.encode(info_bits)
+
+    def decode(self, received):
+        """Polar decode a single frame
+
+        Parameters
+        ----------
+        received : list (or ndarray) of received LLRs, size (n,)
+
+        Returns
+        -------
+        list of decoded bits, size (k,)
+        """
+        return self.c_codec.decode(received)
+
+    def encode_batch(self, const int[:, ::1] info_bits, int[:, ::1] encoded):
+        """Polar encode for multiple frames, in place and without the GIL
+
+        The frames are split in `n_threads` contiguous blocks, each encoded by
+        its own thread.
+
+        Parameters
+        ----------
+        info_bits : C-contiguous ndarray of int32 (np.intc), shape (n_frame, k)
+        encoded : C-contiguous ndarray of int32 (np.intc), shape (n_frame, n)
+            The output array, filled with the polar encoded bits
+        """
+        assert info_bits.shape[1] == self.k and encoded.shape[1] == self.n
+        assert info_bits.shape[0] == encoded.shape[0]
+        cdef int n_frame = info_bits.shape[0]
+        if n_frame == 0:
+            return
+        with nogil:
+            self.c_codec.encode_batch(&info_bits[0, 0], &encoded[0, 0], n_frame)
+
+    def decode_batch(self, const float[:, ::1] received, int[:, ::1] decoded):
+        """Polar decode for multiple frames, in place and without the GIL
+
+        The frames are split in `n_threads` contiguous blocks, each decoded by
+        its own thread: the result does not depend on the number of threads.
+
+        Parameters
+        ----------
+        received : C-contiguous ndarray of float32, shape (n_frame, n)
+        decoded : C-contiguous ndarray of int32 (np.intc), shape (n_frame, k)
+            The output array, filled with the polar decoded bits
+        """
+        assert received.shape[1] == self.n and decoded.shape[1] == self.k
+        assert received.shape[0] == decoded.shape[0]
+        cdef int n_frame = received.shape[0]
+        if n_frame == 0:
+            return
+        with nogil:
+            self.c_codec.decode_batch(&received[0, 0], &decoded[0, 0], n_frame)
+
+    def simulate_ber(self, snr, n_frame, seed=0):
+        """BER/FER simulation over a BPSK/AWGN channel with the current frozen bits
+
+        The source, the modem, the channel (FAST Gaussian generator) and the
+        monitor run in native memory, the encoding and the decoding
+        use `n_threads` threads.
+
+        Parameters
+        ----------
+        snr : float
+            Eb/N0 in dB
+        n_frame : int
+            The number of frames to simulate
+        seed : int
+            The seed of the source and of the channel
+
+        Returns
+        -------
+        dict
+            The counters: "n_be", "n_fe", "n_fra", "ber" and "fer"
+        """
+        cdef float c_snr = snr
+        cdef int c_n_frame = n_frame, c_seed = seed
+        cdef BERCounters counters
+        with nogil:
+            counters = self.c_codec.simulate_ber(c_snr, c_n_frame, c_seed)
+        return counters
@@ -15,8 +15,8 @@ codec_polar = Extension(
     library_dirs=["../../lib/aff3ct/build/lib"],
     include_dirs=["../../lib/aff3ct/include", "../../lib/aff3ct/lib/cli/src", "../../lib/aff3ct/lib/MIPP/src", "../../lib/aff3ct/lib/MIPP/src", "../../lib/aff3ct/lib/rang/include"],
     language="c++",
-    extra_compile_args=["-std=c++11"],
-    extra_link_args=["-std=c++11"]
+    extra_compile_args=["-std=c++11", "-pthread"],
+    extra_link_args=["-std=c++11", "-pthread"]
 )
 setup(
     name="codec_polar",
@@ -1,16 +1,33 @@
 #include <vector>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <tuple>
+#include <map>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
 #include <aff3ct.hpp>
 
 /**
- * @brief Generate frozen bits for a specific SNR
+ * @brief Compute frozen bits for a specific SNR (no caching)
  *
  * @param k The number of information bits
  * @param n The codeword length
  * @param snr_max Estimated SNR (in dB)
+ * @param generator Frozen bits generator type: "GA_Arikan" or "GA"
  * @return auto std::vector<bool> of frozen bits
  */
-std::vector<bool> generate_frozen_bits(const int k, const int n,
-                                       const float snr_max) {
+std::vector<bool> compute_frozen_bits(const int k, const int n,
+                                      const float snr_max,
+                                      const std::string &generator) {
   // calculate constants
   auto r = static_cast<float>(k * 1.0 / n);
   const auto esn0 = aff3ct::tools::ebn0_to_esn0(snr_max, r);
@@ -18,18 +35,698 @@ std::vector<bool> generate_frozen_bits(const int k, const int n,
   const auto sigma = aff3ct::tools::esn0_to_sigma(esn0);
 
   // set noise
-  aff3ct::tools::Frozenbits_generator_GA_Arikan frozen_bits_generator(k, n);
+  std::unique_ptr<aff3ct::tools::Frozenbits_generator> frozen_bits_generator;
+  if (generator == "GA_Arikan")
+    frozen_bits_generator.reset(
+        new aff3ct::tools::Frozenbits_generator_GA_Arikan(k, n));
+  else if (generator == "GA")
+    frozen_bits_generator.reset(
+        new aff3ct::tools::Frozenbits_generator_GA(k, n));
+  else
+    throw std::invalid_argument(
+        "Unsupported frozen bits generator ('generator' = " + generator + ").");
   auto noise = std::unique_ptr<aff3ct::tools::Sigma<>>(
     new aff3ct::tools::Sigma<>());
   noise->set_values(sigma, ebn0, esn0);
 
   // generate frozen bits
   std::vector<bool> frozen_bits(n);
-  frozen_bits_generator.set_noise(*noise);
-  frozen_bits_generator.generate(frozen_bits);
+  frozen_bits_generator->set_noise(*noise);
+  frozen_bits_generator->generate(frozen_bits);
   return frozen_bits;
 }
 
+/**
+ * @brief Thread-safe memoization of the frozen bits generation
+ *
+ * The entries are keyed by (k, n, quantized SNR, generator type). The SNR is
+ * rounded to a multiple of the quantization step and the frozen bits are
+ * computed at the rounded SNR, so an entry does not depend on which SNR of
+ * its bucket was requested first. The cache can be saved to and reloaded
+ * from a text file to share it between runs and processes.
+ */
+class FrozenBitsCache {
+public:
+  /**
+   * @param snr_step SNR quantization step (in dB)
+   */
+  explicit FrozenBitsCache(const float snr_step = 0.001f)
+      : snr_step(snr_step) {
+    if (snr_step <= 0.f)
+      throw std::invalid_argument("'snr_step' has to be strictly positive.");
+  }
+
+  /**
+   * @brief Get the frozen bits, compute them only on a cache miss
+   *
+   * @param k The number of information bits
+   * @param n The codeword length
+   * @param snr_max Estimated SNR (in dB)
+   * @param generator Frozen bits generator type: "GA_Arikan" or "GA"
+   * @return auto std::vector<bool> of frozen bits
+   */
+  std::vector<bool> get(const int k, const int n, const float snr_max,
+                        const std::string &generator = "GA_Arikan") {
+    const key_type key(k, n, std::llround(snr_max / snr_step), generator);
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      auto it = entries.find(key);
+      if (it != entries.end())
+        return it->second;
+    }
+
+    // the generation runs out of the lock, concurrent misses on the same key
+    // compute the same frozen bits and only the first one is stored
+    auto frozen_bits =
+        compute_frozen_bits(k, n, std::get<2>(key) * snr_step, generator);
+    std::lock_guard<std::mutex> lock(mtx);
+    return entries.emplace(key, std::move(frozen_bits)).first->second;
+  }
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return entries.size();
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    entries.clear();
+  }
+
+  /**
+   * @brief Save the cache, the file is written beside and renamed so that
+   * concurrent readers never see a partial file
+   *
+   * @param path The cache file path
+   */
+  void save(const std::string &path) const {
+    const auto tmp_path = path + ".tmp";
+    {
+      std::ofstream file(tmp_path);
+      if (!file.is_open())
+        throw std::runtime_error("Impossible to open '" + tmp_path + "'.");
+
+      file << header << snr_step << std::endl;
+      std::lock_guard<std::mutex> lock(mtx);
+      for (const auto &e : entries) {
+        file << std::get<0>(e.first) << ' ' << std::get<1>(e.first) << ' '
+             << std::get<2>(e.first) << ' ' << std::get<3>(e.first) << ' ';
+        for (const auto fb : e.second)
+          file << (fb ? '1' : '0');
+        file << '\n';
+      }
+      if (!file.good())
+        throw std::runtime_error("Impossible to write '" + tmp_path + "'.");
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+      throw std::runtime_error("Impossible to rename '" + tmp_path +
+                               "' into '" + path + "'.");
+  }
+
+  /**
+   * @brief Load entries from a file saved with the same SNR step, entries
+   * already in the cache are kept
+   *
+   * The keys of the file are multiples of its SNR step: a file saved with
+   * another step (or without the header line) is rejected.
+   *
+   * @param path The cache file path
+   * @return The number of entries read from the file
+   */
+  size_t load(const std::string &path) {
+    std::ifstream file(path);
+    if (!file.is_open())
+      throw std::runtime_error("Impossible to open '" + path + "'.");
+
+    size_t n_entries = 0;
+    bool step_checked = false;
+    std::string line;
+    while (std::getline(file, line)) {
+      if (line.compare(0, header.size(), header) == 0) {
+        float file_step = 0.f;
+        std::istringstream(line.substr(header.size())) >> file_step;
+        if (std::fabs(file_step - snr_step) > 1e-4f * snr_step)
+          throw std::runtime_error(
+              "The SNR step of '" + path + "' does not match the cache "
+              "('file_step' = " + std::to_string(file_step) +
+              ", 'snr_step' = " + std::to_string(snr_step) + ").");
+        step_checked = true;
+        continue;
+      }
+      if (line.empty() || line[0] == '#')
+        continue;
+      if (!step_checked)
+        throw std::runtime_error("'" + path + "' has no SNR step header.");
+
+      std::istringstream iss(line);
+      int k, n;
+      long long snr_q;
+      std::string generator, bits;
+      if (!(iss >> k >> n >> snr_q >> generator >> bits) ||
+          bits.size() != (size_t)n)
+        throw std::runtime_error("Invalid entry in '" + path + "' ('line' = " +
+                                 line + ").");
+
+      std::vector<bool> frozen_bits(n);
+      for (auto i = 0; i < n; i++)
+        frozen_bits[i] = bits[i] == '1';
+
+      std::lock_guard<std::mutex> lock(mtx);
+      entries.emplace(key_type(k, n, snr_q, generator), std::move(frozen_bits));
+      n_entries++;
+    }
+    return n_entries;
+  }
+
+private:
+  using key_type = std::tuple<int, int, long long, std::string>;
+
+  const std::string header = "# frozen bits cache, snr_step = ";
+  const float snr_step;
+  mutable std::mutex mtx;
+  std::map<key_type, std::vector<bool>> entries;
+};
+
+/**
+ * @brief The frozen bits cache shared by all the functions of this file
+ */
+FrozenBitsCache &frozen_bits_cache() {
+  static FrozenBitsCache cache;
+  return cache;
+}
+
+/**
+ * @brief Generate frozen bits for a specific SNR, memoized in
+ * `frozen_bits_cache()`
+ *
+ * @param k The number of information bits
+ * @param n The codeword length
+ * @param snr_max Estimated SNR (in dB)
+ * @param generator Frozen bits generator type: "GA_Arikan" or "GA"
+ * @return auto std::vector<bool> of frozen bits
+ */
+std::vector<bool>
+generate_frozen_bits(const int k, const int n, const float snr_max,
+                     const std::string &generator = "GA_Arikan") {
+  return frozen_bits_cache().get(k, n, snr_max, generator);
+}
+
+/**
+ * @brief Error counters of a BER/FER simulation
+ */
+struct BERCounters {
+  long long n_be;  // number of bit errors
+  long long n_fe;  // number of frame errors
+  long long n_fra; // number of simulated frames
+  double ber;      // bit error rate
+  double fer;      // frame error rate
+};
+
+/**
+ * @brief Stateful polar codec, built once per (k, n, frozen_bits)
+ *
+ * The encoder, the decoder and the scratch buffers are allocated in the
+ * constructor and reused by every call, so the per-call cost is only the
+ * kernel itself.
+ *
+ * Available decoder types:
+ *   - "SC_NAIVE":      successive cancellation, reference implementation
+ *   - "SC_FAST":       fast successive cancellation (systematic code)
+ *   - "SC_FAST_INTER": fast SC, one frame per SIMD lane (systematic code)
+ *   - "SCL":           fast successive cancellation list (systematic code)
+ *   - "CASCL":         CRC-aided fast SCL (systematic code), the CRC is added
+ *                      by the encoder so `frozen_bits` has to leave
+ *                      `k + get_crc_size()` bits unfrozen
+ * The fast decoders need a systematic encoding, the encoder of the codec is
+ * chosen accordingly: only encode with the codec that decodes.
+ */
+class PolarCodec {
+public:
+  /**
+   * @brief Build the polar encoder and decoder
+   *
+   * @param k The number of information bits
+   * @param n The codeword length
+   * @param frozen_bits std::vector<bool>, frozen bits (length n)
+   * @param decoder_type The decoder type (see the class description)
+   * @param list_size The list size of the "SCL" and "CASCL" decoders
+   * @param crc_poly The CRC polynomial of the "CASCL" decoder
+   */
+  PolarCodec(const int k, const int n, const std::vector<bool> &frozen_bits,
+             const std::string &decoder_type = "SC_NAIVE",
+             const int list_size = 8,
+             const std::string &crc_poly = "8-DVB-S2")
+      : k(k), n(n), decoder_type(decoder_type),
+        // checked here: the encoder and the decoder are built from it
+        frozen_bits(check_frozen_bits(frozen_bits, n)),
+        crc(decoder_type == "CASCL"
+                ? new aff3ct::module::CRC_polynomial<int>(k, crc_poly)
+                : nullptr),
+        k_crc(k + (crc ? crc->get_size() : 0)), encoder(build_encoder()),
+        n_frames_per_call(1), encoded_buffer(n), decoded_buffer(k) {
+    std::unique_ptr<aff3ct::module::Decoder_SIHO<int, float>> decoder(
+        build_decoder(list_size));
+    // pack one frame per SIMD lane in the inter-frame decoders
+    decoder->set_n_frames(decoder->get_n_frames_per_wave());
+    n_frames_per_call = (int)decoder->get_n_frames();
+    add_worker(decoder.release());
+  }
+
+  ~PolarCodec() { stop_threads(); }
+
+  PolarCodec(const PolarCodec &) = delete;
+  PolarCodec &operator=(const PolarCodec &) = delete;
+
+  int get_k() const { return k; }
+  int get_n() const { return n; }
+  int get_crc_size() const { return k_crc - k; }
+  const std::string &get_decoder_type() const { return decoder_type; }
+  const std::vector<bool> &get_frozen_bits() const { return frozen_bits; }
+
+  /**
+   * @brief Number of frames decoded per call to the decoder (the SIMD width
+   * for "SC_FAST_INTER", 1 otherwise)
+   */
+  int get_n_frames_per_call() const { return n_frames_per_call; }
+
+  int get_n_threads() const { return (int)workers.size(); }
+
+  /**
+   * @brief Set the number of threads used by `encode_batch` and
+   * `decode_batch`
+   *
+   * Each thread owns a clone of the encoder, of the decoder and their scratch
+   * buffers. The clones and the threads are built here: the threads are
+   * parked on a condition variable between the batches, a batch only wakes
+   * them up (the calling thread is one of the workers).
+   *
+   * @param n_threads The number of threads (0 = the number of hardware
+   * threads)
+   */
+  void set_n_threads(int n_threads) {
+    if (n_threads < 0)
+      throw std::invalid_argument("'n_threads' has to be positive "
+                                  "('n_threads' = " +
+                                  std::to_string(n_threads) + ").");
+    if (n_threads == 0)
+      n_threads = std::max(1, (int)std::thread::hardware_concurrency());
+
+    stop_threads();
+    workers.resize(std::min((size_t)n_threads, workers.size()));
+    while ((int)workers.size() < n_threads)
+      add_worker(workers[0].decoder->clone());
+    errors.assign(workers.size(), nullptr);
+    for (size_t t = 1; t < workers.size(); t++)
+      threads.emplace_back(&PolarCodec::thread_loop, this, (int)t);
+  }
+
+  /**
+   * @brief Replace the frozen bits in place (no reallocation)
+   *
+   * @param frozen_bits std::vector<bool>, the new frozen bits (length n)
+   */
+  void set_frozen_bits(const std::vector<bool> &frozen_bits) {
+    check_frozen_bits(frozen_bits, n);
+    std::copy(frozen_bits.begin(), frozen_bits.end(),
+              this->frozen_bits.begin());
+    for (auto &w : workers) {
+      w.encoder->set_frozen_bits(this->frozen_bits);
+      w.decoder_fb->set_frozen_bits(this->frozen_bits);
+    }
+  }
+
+  /**
+   * @brief Encode a single frame
+   *
+   * @param info_bits std::vector<int>, information bits (length k)
+   * @return Encoded codeword (length n), valid until the next call
+   */
+  const std::vector<int> &encode(const std::vector<int> &info_bits) {
+    check_size("info_bits", info_bits.size(), k);
+    encode_batch(info_bits.data(), encoded_buffer.data(), 1);
+    return encoded_buffer;
+  }
+
+  /**
+   * @brief Decode a single frame
+   *
+   * @param received std::vector<float> soft symbols, BPSK (length n)
+   * @return Decoded information bits (length k), valid until the next call
+   */
+  const std::vector<int> &decode(const std::vector<float> &received) {
+    check_size("received", received.size(), n);
+    decode_batch(received.data(), decoded_buffer.data(), 1);
+    return decoded_buffer;
+  }
+
+  /**
+   * @brief Encode a batch of contiguous frames
+   *
+   * The batch is split in `get_n_threads()` contiguous blocks of frames,
+   * worker `t` encodes block `t` with its own encoder.
+   *
+   * @param info_bits Row-major information bits, n_frame rows, k columns
+   * @param encoded_bits Row-major output buffer, n_frame rows, n columns
+   * @param n_frame The number of frames in the batch
+   */
+  void encode_batch(const int *info_bits, int *encoded_bits,
+                    const int n_frame) {
+    const int n_threads = std::min((int)workers.size(), n_frame);
+    run(n_threads, [this, info_bits, encoded_bits, n_frame,
+                    n_threads](const int t) {
+      const int first = (int)((long long)n_frame * t / n_threads);
+      const int last = (int)((long long)n_frame * (t + 1) / n_threads);
+      encode_block(workers[t], info_bits + (size_t)first * k,
+                   encoded_bits + (size_t)first * n, last - first);
+    });
+  }
+
+  /**
+   * @brief Decode a batch of contiguous frames
+   *
+   * The batch is split in `get_n_threads()` contiguous blocks of frames (a
+   * multiple of `get_n_frames_per_call()` frames each), worker `t` decodes
+   * block `t` with its own decoder: the output does not depend on the
+   * scheduling. The calling thread is the worker 0.
+   *
+   * @param received Row-major soft symbols, BPSK, n_frame rows, n columns
+   * @param decoded_bits Row-major output buffer, n_frame rows, k columns
+   * @param n_frame The number of frames in the batch
+   */
+  void decode_batch(const float *received, int *decoded_bits,
+                    const int n_frame) {
+    const int n_calls = (n_frame + n_frames_per_call - 1) / n_frames_per_call;
+    const int n_threads = std::min((int)workers.size(), n_calls);
+    run(n_threads, [this, received, decoded_bits, n_frame, n_calls,
+                    n_threads](const int t) {
+      // balance the calls to the decoder, not the frames
+      const int first_call =
+          n_calls / n_threads * t + std::min(t, n_calls % n_threads);
+      const int calls = n_calls / n_threads + (t < n_calls % n_threads);
+      const int first = first_call * n_frames_per_call;
+      const int last = std::min(n_frame, first + calls * n_frames_per_call);
+      decode_block(workers[t], received + (size_t)first * n,
+                   decoded_bits + (size_t)first * k, last - first);
+    });
+  }
+
+  /**
+   * @brief Monte Carlo simulation of the codec over a BPSK/AWGN channel
+   *
+   * Runs Source_random -> encoder -> Modem_BPSK -> Channel_AWGN_LLR (FAST
+   * Gaussian generator) -> decoder -> Monitor_BFER on native buffers, chunk
+   * by chunk, and only returns the counters. The encoding and the decoding use
+   * `get_n_threads()` threads of the codec.
+   *
+   * @param ebn0 The Eb/N0 (in dB), the code rate is k/n
+   * @param n_frame The number of frames to simulate
+   * @param seed The seed of the source and of the channel
+   * @return The bit and frame error counters
+   */
+  BERCounters simulate_ber(const float ebn0, const int n_frame,
+                           const int seed = 0) {
+    using namespace aff3ct;
+
+    const auto esn0 = tools::ebn0_to_esn0(ebn0, (float)k / (float)n);
+    const auto sigma = tools::esn0_to_sigma(esn0);
+
+    // enough frames per chunk to keep all the workers busy
+    const int chunk_size = std::max(
+        1, std::min(n_frame, 64 * n_frames_per_call * get_n_threads()));
+
+    module::Source_random<int> source(k, seed);
+    module::Modem_BPSK<int, float, float> modem(n);
+    module::Channel_AWGN_LLR<float> channel(
+        n, tools::Gaussian_noise_generator_implem::FAST);
+    module::Monitor_BFER<int> monitor(k, (unsigned)n_frame);
+    channel.set_seed(seed + 1);
+
+    std::vector<int> U_K, X_N, V_K;
+    std::vector<float> S_N, Y_N, L_N, CP;
+    for (auto f = 0; f < n_frame; f += chunk_size) {
+      const auto n_cur = std::min(chunk_size, n_frame - f);
+      if (f == 0 || n_cur != chunk_size) {
+        for (module::Module *m : std::vector<module::Module *>{
+                 &source, &modem, &channel, &monitor})
+          m->set_n_frames((size_t)n_cur);
+        U_K.resize((size_t)n_cur * k);
+        V_K.resize((size_t)n_cur * k);
+        X_N.resize((size_t)n_cur * n);
+        S_N.resize((size_t)n_cur * n);
+        Y_N.resize((size_t)n_cur * n);
+        L_N.resize((size_t)n_cur * n);
+        CP.assign((size_t)n_cur, sigma);
+      }
+
+      source.generate(U_K);
+      encode_batch(U_K.data(), X_N.data(), n_cur);
+      modem.modulate(X_N, S_N);
+      channel.add_noise(CP, S_N, Y_N);
+      modem.demodulate(CP, Y_N, L_N);
+      decode_batch(L_N.data(), V_K.data(), n_cur);
+      monitor.check_errors(V_K, U_K);
+    }
+
+    BERCounters counters;
+    counters.n_be = (long long)monitor.get_n_be();
+    counters.n_fe = (long long)monitor.get_n_fe();
+    counters.n_fra = (long long)monitor.get_n_analyzed_fra();
+    counters.ber = counters.n_fra ? (double)monitor.get_ber() : 0.;
+    counters.fer = counters.n_fra ? (double)monitor.get_fer() : 0.;
+    return counters;
+  }
+
+private:
+  aff3ct::module::Encoder_polar<int> *build_encoder() const {
+    if (decoder_type == "SC_NAIVE")
+      return new aff3ct::module::Encoder_polar<int>(k_crc, n, frozen_bits);
+    else
+      return new aff3ct::module::Encoder_polar_sys<int>(k_crc, n, frozen_bits);
+  }
+
+  aff3ct::module::Decoder_SIHO<int, float> *
+  build_decoder(const int list_size) const {
+    using namespace aff3ct;
+    using API_seq = tools::API_polar_dynamic_seq<int, float>;
+    using API_inter = tools::API_polar_dynamic_inter<int, float>;
+
+    if (decoder_type == "SC_NAIVE")
+      return new module::Decoder_polar_SC_naive<int, float>(k_crc, n,
+                                                            frozen_bits);
+    if (decoder_type == "SC_FAST")
+      return new module::Decoder_polar_SC_fast_sys<int, float, API_seq>(
+          k_crc, n, frozen_bits);
+    if (decoder_type == "SC_FAST_INTER")
+      return new module::Decoder_polar_SC_fast_sys<int, float, API_inter>(
+          k_crc, n, frozen_bits);
+    if (decoder_type == "SCL")
+      return new module::Decoder_polar_SCL_fast_sys<int, float, API_seq>(
+          k_crc, n, list_size, frozen_bits);
+    if (decoder_type == "CASCL")
+      return new module::Decoder_polar_SCL_fast_CA_sys<int, float, API_seq>(
+          k_crc, n, list_size, frozen_bits, *crc);
+
+    throw std::invalid_argument("Unsupported decoder type ('decoder_type' = " +
+                                decoder_type + ").");
+  }
+
+  /**
+   * @brief An encoder, a decoder and their scratch buffers, owned by one
+   * thread (the worker 0 uses the encoder and the CRC of the codec)
+   */
+  struct Worker {
+    std::unique_ptr<aff3ct::module::Decoder_SIHO<int, float>> decoder;
+    aff3ct::tools::Interface_get_set_frozen_bits *decoder_fb;
+    std::unique_ptr<aff3ct::module::Encoder_polar<int>> encoder_clone;
+    std::unique_ptr<aff3ct::module::CRC<int>> crc_clone;
+    aff3ct::module::Encoder_polar<int> *encoder;
+    aff3ct::module::CRC<int> *crc; // nullptr if there is no CRC
+    std::vector<float> llr_buffer;
+    std::vector<int> bit_buffer;
+    std::vector<int> crc_buffer;
+  };
+
+  void add_worker(aff3ct::module::Decoder_SIHO<int, float> *decoder) {
+    workers.emplace_back();
+    auto &w = workers.back();
+    w.decoder.reset(decoder);
+    w.decoder_fb =
+        dynamic_cast<aff3ct::tools::Interface_get_set_frozen_bits *>(decoder);
+    if (workers.size() == 1) {
+      w.encoder = encoder.get();
+      w.crc = crc.get();
+    } else {
+      w.encoder_clone.reset(encoder->clone());
+      w.crc_clone.reset(crc ? crc->clone() : nullptr);
+      w.encoder = w.encoder_clone.get();
+      w.crc = w.crc_clone.get();
+    }
+    w.llr_buffer.resize((size_t)n_frames_per_call * n);
+    w.bit_buffer.resize((size_t)n_frames_per_call * k_crc);
+    w.crc_buffer.resize(crc ? k_crc : 0);
+  }
+
+  /**
+   * @brief Run `job(t)` on the workers 0 to `n_active - 1`, the calling thread
+   * runs `job(0)` and the parked threads the others
+   */
+  void run(const int n_active, const std::function<void(const int)> &job) {
+    if (n_active <= 1) {
+      job(0);
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(pool_mtx);
+      std::fill(errors.begin(), errors.end(), nullptr);
+      pool_job = &job;
+      pool_n_active = n_active;
+      pool_n_pending = n_active - 1;
+      pool_generation++;
+    }
+    pool_cv.notify_all();
+
+    try {
+      job(0);
+    } catch (...) {
+      errors[0] = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock(pool_mtx);
+    done_cv.wait(lock, [this]() { return pool_n_pending == 0; });
+    pool_job = nullptr;
+    for (auto &e : errors)
+      if (e)
+        std::rethrow_exception(e);
+  }
+
+  void thread_loop(const int t) {
+    size_t generation = 0;
+    while (true) {
+      const std::function<void(const int)> *job;
+      {
+        std::unique_lock<std::mutex> lock(pool_mtx);
+        pool_cv.wait(lock, [this, generation]() {
+          return pool_stop || pool_generation != generation;
+        });
+        if (pool_stop)
+          return;
+        generation = pool_generation;
+        if (t >= pool_n_active)
+          continue;
+        job = pool_job;
+      }
+
+      try {
+        (*job)(t);
+      } catch (...) {
+        errors[t] = std::current_exception();
+      }
+
+      std::lock_guard<std::mutex> lock(pool_mtx);
+      if (--pool_n_pending == 0)
+        done_cv.notify_one();
+    }
+  }
+
+  void stop_threads() {
+    {
+      std::lock_guard<std::mutex> lock(pool_mtx);
+      pool_stop = true;
+    }
+    pool_cv.notify_all();
+    for (auto &th : threads)
+      th.join();
+    threads.clear();
+    pool_stop = false;
+  }
+
+  void encode_block(Worker &w, const int *info_bits, int *encoded_bits,
+                    const int n_frame) const {
+    for (auto f = 0; f < n_frame; f++) {
+      const int *U_K = info_bits + (size_t)f * k;
+      if (w.crc) {
+        w.crc->build(U_K, w.crc_buffer.data());
+        U_K = w.crc_buffer.data();
+      }
+      w.encoder->encode(U_K, encoded_bits + (size_t)f * n);
+    }
+  }
+
+  /**
+   * @brief Decode contiguous frames with one decoder
+   *
+   * The frames are given to the decoder `n_frames_per_call` at a time,
+   * straight from `received` (the inter-frame decoder reorders them in its
+   * SIMD layout). Only an incomplete last group of frames goes through the
+   * (zero-padded) scratch buffer.
+   */
+  void decode_block(Worker &w, const float *received, int *decoded_bits,
+                    const int n_frame) const {
+    for (auto f = 0; f < n_frame; f += n_frames_per_call) {
+      const auto n_cur = std::min(n_frames_per_call, n_frame - f);
+
+      const float *Y_N = received + (size_t)f * n;
+      if (n_cur < n_frames_per_call) {
+        std::copy(Y_N, Y_N + (size_t)n_cur * n, w.llr_buffer.begin());
+        std::fill(w.llr_buffer.begin() + (size_t)n_cur * n,
+                  w.llr_buffer.end(), 0.f);
+        Y_N = w.llr_buffer.data();
+      }
+
+      const bool direct = n_cur == n_frames_per_call && !crc;
+      int *V_K = direct ? decoded_bits + (size_t)f * k : w.bit_buffer.data();
+      w.decoder->decode_siho(Y_N, V_K);
+
+      // drop the CRC bits (appended after the information bits) and/or the
+      // padding frames
+      if (!direct)
+        for (auto i = 0; i < n_cur; i++)
+          std::copy(w.bit_buffer.begin() + (size_t)i * k_crc,
+                    w.bit_buffer.begin() + (size_t)i * k_crc + k,
+                    decoded_bits + (size_t)(f + i) * k);
+    }
+  }
+
+  static const std::vector<bool> &
+  check_frozen_bits(const std::vector<bool> &frozen_bits, const int n) {
+    check_size("frozen_bits", frozen_bits.size(), n);
+    return frozen_bits;
+  }
+
+  static void check_size(const std::string &name, const size_t size,
+                         const int expected) {
+    if (size != (size_t)expected)
+      throw std::invalid_argument("'" + name + ".size()' has to be equal to " +
+                                  std::to_string(expected) + " ('" + name +
+                                  ".size()' = " + std::to_string(size) + ").");
+  }
+
+  const int k;
+  const int n;
+  const std::string decoder_type;
+  std::vector<bool> frozen_bits;
+  std::unique_ptr<aff3ct::module::CRC<int>> crc;
+  const int k_crc; // k + the CRC size
+  std::unique_ptr<aff3ct::module::Encoder_polar<int>> encoder;
+  int n_frames_per_call;
+  std::vector<int> encoded_buffer;
+  std::vector<int> decoded_buffer;
+  std::vector<Worker> workers; // the clones are made from workers[0]
+
+  // pool of the workers 1 to get_n_threads() - 1, parked between the batches
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> errors; // one per worker
+  std::mutex pool_mtx;
+  std::condition_variable pool_cv; // wakes up the parked threads
+  std::condition_variable done_cv; // the last thread of a batch is done
+  const std::function<void(const int)> *pool_job = nullptr;
+  size_t pool_generation = 0; // incremented on each batch
+  int pool_n_active = 0;
+  int pool_n_pending = 0;
+  bool pool_stop = false;
+};
+
 /**
  * @brief Polar encoder for single frame
  *
@@ -67,16 +764,44 @@ polar_encode_multiple(const int k, const int n,
   // populate vector
   std::vector<std::vector<int>> encoded_bits;
 
+  encoded_bits.reserve(info_bits.size());
+
   // encode
   aff3ct::module::Encoder_polar<int> polar_encoder(k, n, frozen_bits);
-  for (auto frame : info_bits) {
-    std::vector<int> encoded(n);
-    polar_encoder.encode(frame, encoded);
-    encoded_bits.push_back(encoded);
+  for (const auto &frame : info_bits) {
+    encoded_bits.emplace_back(n);
+    polar_encoder.encode(frame, encoded_bits.back());
   }
   return encoded_bits;
 }
 
+/**
+ * @brief Polar encoder for a batch of contiguous frames (no intermediate copy)
+ *
+ * @param k The number of information bits
+ * @param n The codeword length
+ * @param frozen_bits std::vector<bool>, frozen bits (length n)
+ * @param info_bits Row-major information bits, n_frame rows, k columns
+ * @param encoded_bits Row-major output buffer, n_frame rows, n columns
+ * @param n_frame The number of frames in the batch
+ * @param decoder_type The decoder type the frames will be decoded with (it
+ * selects a systematic or a non-systematic encoding, see PolarCodec)
+ * @param list_size The list size of the "SCL" and "CASCL" decoders
+ * @param crc_poly The CRC polynomial of the "CASCL" decoder (appended by the
+ * encoder)
+ */
+void polar_encode_batch(const int k, const int n,
+                        const std::vector<bool> &frozen_bits,
+                        const int *info_bits, int *encoded_bits,
+                        const int n_frame,
+                        const std::string &decoder_type = "SC_NAIVE",
+                        const int list_size = 8,
+                        const std::string &crc_poly = "8-DVB-S2") {
+  // encode
+  PolarCodec codec(k, n, frozen_bits, decoder_type, list_size, crc_poly);
+  codec.encode_batch(info_bits, encoded_bits, n_frame);
+}
+
 /**
  * @brief Polar decoder for single frame
  *
@@ -116,12 +841,76 @@ polar_decode_multiple(const int k, const int n,
   // populate vectors
   std::vector<std::vector<int>> decoded_bits;
 
+  decoded_bits.reserve(received.size());
+
   // decode
   aff3ct::module::Decoder_polar_SC_naive<int> polar_decoder(k, n, frozen_bits);
-  for (auto frame : received) {
-    std::vector<int> decoded(k);
-    polar_decoder.decode_siho(frame, decoded);
-    decoded_bits.push_back(decoded);
+  for (const auto &frame : received) {
+    decoded_bits.emplace_back(k);
+    polar_decoder.decode_siho(frame, decoded_bits.back());
   }
   return decoded_bits;
 }
+
+/**
+ * @brief Polar decoder for a batch of contiguous frames (no intermediate copy)
+ *
+ * @param k The number of information bits
+ * @param n The codeword length
+ * @param frozen_bits std::vector<bool>, frozen bits (length n)
+ * @param received Row-major soft symbols, BPSK, n_frame rows, n columns
+ * @param decoded_bits Row-major output buffer, n_frame rows, k columns
+ * @param n_frame The number of frames in the batch
+ * @param decoder_type The decoder type (see PolarCodec)
+ * @param list_size The list size of the "SCL" and "CASCL" decoders
+ * @param crc_poly The CRC polynomial of the "CASCL" decoder
+ * @param n_threads The number of decoding threads (0 = the number of hardware
+ * threads), see PolarCodec::set_n_threads
+ */
+void polar_decode_batch(const int k, const int n,
+                        const std::vector<bool> &frozen_bits,
+                        const float *received, int *decoded_bits,
+                        const int n_frame,
+                        const std::string &decoder_type = "SC_NAIVE",
+                        const int list_size = 8,
+                        const std::string &crc_poly = "8-DVB-S2",
+                        const int n_threads = 1) {
+  // decode
+  PolarCodec codec(k, n, frozen_bits, decoder_type, list_size, crc_poly);
+  codec.set_n_threads(n_threads);
+  codec.decode_batch(received, decoded_bits, n_frame);
+}
+
+/**
+ * @brief BER/FER simulation of a polar code over a BPSK/AWGN channel
+ *
+ * The frozen bits are generated (and cached) for `snr`, see
+ * PolarCodec::simulate_ber for the simulated chain.
+ *
+ * @param k The number of information bits
+ * @param n The codeword length
+ * @param snr The Eb/N0 (in dB)
+ * @param n_frame The number of frames to simulate
+ * @param seed The seed of the source and of the channel
+ * @param decoder_type The decoder type (see PolarCodec)
+ * @param list_size The list size of the "SCL" and "CASCL" decoders
+ * @param crc_poly The CRC polynomial of the "CASCL" decoder
+ * @param n_threads The number of decoding threads (0 = the number of hardware
+ * threads)
+ * @return The bit and frame error counters
+ */
+BERCounters simulate_ber(const int k, const int n, const float snr,
+                         const int n_frame, const int seed = 0,
+                         const std::string &decoder_type = "SC_NAIVE",
+                         const int list_size = 8,
+                         const std::string &crc_poly = "8-DVB-S2",
+                         const int n_threads = 1) {
+  const int crc_size =
+      decoder_type == "CASCL"
+          ? aff3ct::module::CRC_polynomial<int>::get_size(crc_poly)
+          : 0;
+  PolarCodec codec(k, n, generate_frozen_bits(k + crc_size, n, snr),
+                   decoder_type, list_size, crc_poly);
+  codec.set_n_threads(n_threads);
+  return codec.simulate_ber(snr, n_frame, seed);
+}
@@ -30,17 +30,17 @@ int main() {
   // polar encode
   auto encoded_bits = polar_encode(k, n, frozen_bits, info_bits);
 
-  // generate gaussian noise
-  const float mean = 0.0;
-  const float stddev = std::sqrt(std::pow(10, -snr_max / 10.0));
-  std::normal_distribution<float> dist(mean, stddev);
-  std::default_random_engine generator;
-
-  // awgn channel
-  std::vector<float> received;
-  std::transform(
-      encoded_bits.begin(), encoded_bits.end(), std::back_inserter(received),
-      [&](const int i) -> float { return -i * 2 + 1 + dist(generator); });
+  // BPSK modulation and AWGN channel (snr_max taken as Eb/N0)
+  const float sigma = tools::esn0_to_sigma(
+      tools::ebn0_to_esn0(snr_max, (float)k / (float)n));
+  const std::vector<float> noise_params(1, sigma);
+  module::Modem_BPSK<> modem(n);
+  module::Channel_AWGN_LLR<> channel(
+      n, tools::Gaussian_noise_generator_implem::FAST);
+  std::vector<float> symbols(n), noisy_symbols(n), received(n);
+  modem.modulate(encoded_bits, symbols);
+  channel.add_noise(noise_params, symbols, noisy_symbols);
+  modem.demodulate(noise_params, noisy_symbols, received);
 
   // polar decode
   auto decoded_bits = polar_decode(k, n, frozen_bits, received);
@@ -58,6 +58,15 @@ int main() {
       std::cout << i << ' ';
     }
   }
+  std::cout << std::endl;
+
+  // full simulation chain in native memory, only the counters come back
+  const int n_frame = 10000;
+  const auto counters = simulate_ber(k, n, snr_max, n_frame);
+  std::cout << "--- simulate_ber      ---" << std::endl;
+  std::cout << "frames=" << counters.n_fra << " bit errors=" << counters.n_be
+            << " frame errors=" << counters.n_fe << " BER=" << counters.ber
+            << " FER=" << counters.fer << std::endl;
 
   return 0;
 }
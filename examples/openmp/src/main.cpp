@@ -18,12 +18,18 @@ inline int omp_get_thread_num () { return 0; }
 inline int omp_get_num_threads() { return 1; }
 #endif
 
+#include "SNR_scheduler.hpp"
+#include "Monitor_BFER_counter.hpp"
+#include "Socket_arena.hpp"
+
 struct params
 {
 	float ebn0_min  =  0.00f; // minimum SNR value
 	float ebn0_max  = 10.01f; // maximum SNR value
 	float ebn0_step =  1.00f; // SNR step
 	float R;                  // code rate (R=K/N)
+	size_t n_frames_chunk = 100; // frames simulated on a SNR point before a thread looks for a more loaded point
+	bool   socket_arena = false; // allocate the output sockets of the chain of each thread in one block
 
 	std::unique_ptr<factory::Source          > source;
 	std::unique_ptr<factory::Codec_repetition> codec;
@@ -38,26 +44,42 @@ namespace aff3ct { namespace tools {
 using Monitor_BFER_reduction = Monitor_reduction<module::Monitor_BFER<>>;
 } }
 
-struct utils
+// the SNR points are simulated in parallel, each one has its own noise, monitors and terminal
+struct snr_point
 {
+	float ebn0;  // Eb/N0 (in dB)
+	float esn0;  // Es/N0 (in dB)
+	float sigma; // channel noise
+
 	            std::unique_ptr<tools ::Sigma<>               >  noise;       // a sigma noise type
 	std::vector<std::unique_ptr<tools ::Reporter              >> reporters;   // list of reporters displayed in the terminal
 	            std::unique_ptr<tools ::Terminal              >  terminal;    // manage the output text in the terminal
 	std::vector<std::unique_ptr<module::Monitor_BFER<>        >> monitors;    // list of the monitors from all the threads
 	            std::unique_ptr<tools ::Monitor_BFER_reduction>  monitor_red; // main monitor object that reduce all the thread monitors
+	            std::unique_ptr<tools ::Monitor_BFER_counter<>>  fe_counter;  // low contention stop criterion (frame errors)
+};
+
+struct utils
+{
+	std::vector<snr_point>                points;    // the SNR points of the sweep
+	std::unique_ptr<tools::SNR_scheduler> scheduler; // distribute the threads over the SNR points
+	std::unique_ptr<tools::Terminal>      terminal;  // Ctrl+c state of the sweep (no reporter)
 
 	std::vector<std::vector<const module::Module*>> modules;       // lists of the allocated modules
 	std::vector<std::vector<const module::Module*>> modules_stats; // list of the allocated modules reorganized for the statistics
 };
-void init_utils(const params &p, utils &u);
+void init_points(const params &p, const size_t n_threads, utils &u);
+void init_utils (const params &p, utils &u);
+void report     (snr_point &pt);
 
 struct modules
 {
+	std::unique_ptr<tools::Socket_arena>    arena; // output sockets of the chain of the thread (if enabled), outlives the tasks
 	std::unique_ptr<module::Source<>>       source;
 	std::unique_ptr<tools ::Codec_SIHO<>>   codec;
 	std::unique_ptr<module::Modem<>>        modem;
 	std::unique_ptr<module::Channel<>>      channel;
-	                module::Monitor_BFER<>* monitor;
+	std::vector<module::Monitor_BFER<>*>    monitors; // the monitors of this thread (one per SNR point)
 	                module::Encoder<>*      encoder;
 	                module::Decoder_SIHO<>* decoder;
 	std::vector<const module::Module*>      list; // list of module pointers declared in this structure
@@ -86,8 +108,8 @@ int main(int argc, char** argv)
 {
 	// get the number of available threads from OpenMP
 	const size_t n_threads = (size_t)omp_get_num_threads();
-	u.monitors.resize(n_threads);
-	u.modules .resize(n_threads);
+	init_points(p, n_threads, u);
+	u.modules.resize(n_threads);
 }
 	modules m; init_modules_and_utils(p, m, u); // create and initialize the modules and initialize a part of the utils
 
@@ -97,11 +119,13 @@ int main(int argc, char** argv)
 	init_utils(p, u); // finalize the utils initialization
 
 	// display the legend in the terminal
-	u.terminal->legend();
+	if (!u.points.empty())
+		u.points[0].terminal->legend();
 }
 
-	// set the noise and register modules to "noise changed" callback
-	m.codec->set_noise(*u.noise); u.noise->record_callback_update([&m](){ m.codec->notify_noise_update(); });
+	// the noise of the thread follows the SNR point it simulates, register the codec to "noise changed" callback
+	tools::Sigma<> noise;
+	m.codec->set_noise(noise); noise.record_callback_update([&m](){ m.codec->notify_noise_update(); });
 
 	// sockets binding (connect the sockets of the tasks = fill the input sockets with the output sockets)
 	using namespace module;
@@ -110,30 +134,34 @@ int main(int argc, char** argv)
 	(*m.channel)[chn::sck::add_noise   ::X_N ].bind((*m.modem  )[mdm::sck::modulate   ::X_N2]);
 	(*m.modem  )[mdm::sck::demodulate  ::Y_N1].bind((*m.channel)[chn::sck::add_noise  ::Y_N ]);
 	(*m.decoder)[dec::sck::decode_siho ::Y_N ].bind((*m.modem  )[mdm::sck::demodulate ::Y_N2]);
-	(*m.monitor)[mnt::sck::check_errors::U   ].bind((*m.source )[src::sck::generate   ::U_K ]);
-	(*m.monitor)[mnt::sck::check_errors::V   ].bind((*m.decoder)[dec::sck::decode_siho::V_K ]);
+	for (auto monitor : m.monitors)
+	{
+		(*monitor)[mnt::sck::check_errors::U].bind((*m.source )[src::sck::generate   ::U_K]);
+		(*monitor)[mnt::sck::check_errors::V].bind((*m.decoder)[dec::sck::decode_siho::V_K]);
+	}
 
 	std::vector<float> sigma(1);
 	(*m.channel)[chn::sck::add_noise ::CP].bind(sigma);
 	(*m.modem  )[mdm::sck::demodulate::CP].bind(sigma);
 
-	// loop over the various SNRs
-	for (auto ebn0 = p.ebn0_min; ebn0 < p.ebn0_max; ebn0 += p.ebn0_step)
+	// simulate the SNR points by chunks of frames, the scheduler moves the threads from the finished points to
+	// the remaining ones
+	bool last = false;
+	int  cur  = -1;
+	int  k    = u.scheduler->next(-1, last);
+	while (k != -1 && !u.terminal->is_over())
 	{
-		// compute the current sigma for the channel noise
-		const auto esn0 = tools::ebn0_to_esn0 (ebn0, p.R, p.modem->bps);
-		std::fill(sigma.begin(), sigma.end(), tools::esn0_to_sigma(esn0, p.modem->cpm_upf));
-
-#pragma omp single
-{
-		u.noise->set_values(sigma[0], ebn0, esn0);
-
-		// display the performance (BER and FER) in real time (in a separate thread)
-		u.terminal->start_temp_report();
-}
+		auto &pt = u.points[k];
+		if (k != cur)
+		{
+			std::fill(sigma.begin(), sigma.end(), pt.sigma);
+			noise.set_values(pt.sigma, pt.ebn0, pt.esn0);
+			cur = k;
+		}
 
 		// run the simulation chain
-		while (!u.monitor_red->is_done() && !u.terminal->is_interrupt())
+		auto &monitor = *m.monitors[k];
+		for (size_t f = 0; f < p.n_frames_chunk && !pt.fe_counter->is_done() && !u.terminal->is_interrupt(); f++)
 		{
 			(*m.source )[src::tsk::generate    ].exec();
 			(*m.encoder)[enc::tsk::encode      ].exec();
@@ -141,29 +169,43 @@ int main(int argc, char** argv)
 			(*m.channel)[chn::tsk::add_noise   ].exec();
 			(*m.modem  )[mdm::tsk::demodulate  ].exec();
 			(*m.decoder)[dec::tsk::decode_siho ].exec();
-			(*m.monitor)[mnt::tsk::check_errors].exec();
+			monitor     [mnt::tsk::check_errors].exec();
 		}
 
-// need to wait all the threads here before to reset the 'monitors' and 'terminal' states
-#pragma omp barrier
-#pragma omp single
-{
-		// final reduction
-		u.monitor_red->reduce();
-
-		// display the performance (BER and FER) in the terminal
-		u.terminal->final_report();
-
-		// reset the monitor and the terminal for the next SNR
-		u.monitor_red->reset();
-		u.terminal->reset();
-}
-		// if user pressed Ctrl+c twice, exit the SNRs loop
-		if (u.terminal->is_over()) break;
+		if (pt.fe_counter->is_done())
+			u.scheduler->finish(k);
+
+		// if user pressed Ctrl+c, skip the SNR points in progress (the first thread to see it resets the interrupt for
+		// the next points), if user pressed Ctrl+c twice, exit the SNRs loop
+		if (u.terminal->is_interrupt() && !u.terminal->is_over())
+			u.scheduler->interrupt([&u]()
+			{
+				if (!u.terminal->is_interrupt())
+					return false;
+				u.terminal->reset();
+				return true;
+			});
+
+		// the last thread to leave a finished point displays its performance (BER and FER)
+		const int prev = k;
+		k = u.scheduler->next(prev, last);
+		if (last)
+			report(u.points[prev]);
 	}
 
+// need to wait all the threads here before to report the interrupted points
+#pragma omp barrier
 #pragma omp single
 {
+	// display the performance of the SNR points that have been interrupted (Ctrl+c twice)
+	for (size_t k = 0; k < u.points.size(); k++)
+		if (u.scheduler->set_reported((int)k))
+		{
+			u.points[k].monitor_red->reduce();
+			if (u.points[k].monitor_red->get_n_analyzed_fra())
+				u.points[k].terminal->final_report();
+		}
+
 	// display the statistics of the tasks (if enabled)
 	std::cout << "#" << std::endl;
 	tools::Stats::show(u.modules_stats, true);
@@ -216,19 +258,27 @@ void init_modules_and_utils(const params &p, modules &m, utils &u)
 	m.codec         = std::unique_ptr<tools ::Codec_SIHO  <>>(p.codec  ->build());
 	m.modem         = std::unique_ptr<module::Modem       <>>(p.modem  ->build());
 	m.channel       = std::unique_ptr<module::Channel     <>>(p.channel->build());
-	u.monitors[tid] = std::unique_ptr<module::Monitor_BFER<>>(p.monitor->build());
-	m.monitor       = u.monitors[tid].get();
 	m.encoder       = &m.codec->get_encoder();
 	m.decoder       = &m.codec->get_decoder_siho();
 
-	m.list = { m.source.get(), m.modem.get(), m.channel.get(), m.monitor, m.encoder, m.decoder };
+	// one monitor per SNR point
+	for (auto &pt : u.points)
+	{
+		pt.monitors[tid] = std::unique_ptr<module::Monitor_BFER<>>(p.monitor->build());
+		m.monitors.push_back(pt.monitors[tid].get());
+	}
+
+	m.list = { m.source.get(), m.modem.get(), m.channel.get(), m.encoder, m.decoder };
 	u.modules[tid] = m.list;
 
+	std::vector<const module::Module*> modules = m.list;
+	modules.insert(modules.end(), m.monitors.begin(), m.monitors.end());
+
 	// configuration of the module tasks
-	for (auto& mod : m.list)
+	for (auto& mod : modules)
 		for (auto& tsk : mod->tasks)
 		{
-			tsk->set_autoalloc  (true ); // enable the automatic allocation of the data in the tasks
+			tsk->set_autoalloc  (!p.socket_arena); // enable the automatic allocation of the data in the tasks
 			tsk->set_debug      (false); // disable the debug mode
 			tsk->set_debug_limit(16   ); // display only the 16 first bits if the debug mode is enabled
 			tsk->set_stats      (true ); // enable the statistics
@@ -237,26 +287,84 @@ void init_modules_and_utils(const params &p, modules &m, utils &u)
 			if (!tsk->is_debug() && !tsk->is_stats())
 				tsk->set_fast(true);
 		}
+
+	// the output sockets of the chain of the thread in one 64-byte aligned block (allocated and touched by the thread)
+	if (p.socket_arena)
+	{
+		using namespace module;
+		std::vector<Task*> chain = {&(*m.source )[src::tsk::generate   ],
+		                            &(*m.encoder)[enc::tsk::encode     ],
+		                            &(*m.modem  )[mdm::tsk::modulate   ],
+		                            &(*m.channel)[chn::tsk::add_noise  ],
+		                            &(*m.modem  )[mdm::tsk::demodulate ],
+		                            &(*m.decoder)[dec::tsk::decode_siho]};
+		for (auto &monitor : m.monitors)
+			chain.push_back(&(*monitor)[mnt::tsk::check_errors]);
+		m.arena = std::unique_ptr<tools::Socket_arena>(new tools::Socket_arena(chain));
+	}
+}
+
+void init_points(const params &p, const size_t n_threads, utils &u)
+{
+	for (auto ebn0 = p.ebn0_min; ebn0 < p.ebn0_max; ebn0 += p.ebn0_step)
+	{
+		snr_point pt;
+		pt.ebn0  = ebn0;
+		pt.esn0  = tools::ebn0_to_esn0 (ebn0, p.R, p.modem->bps);
+		pt.sigma = tools::esn0_to_sigma(pt.esn0, p.modem->cpm_upf);
+		pt.monitors.resize(n_threads);
+		u.points.push_back(std::move(pt));
+	}
 }
 
 void init_utils(const params &p, utils &u)
 {
-	// allocate a common monitor module to reduce all the monitors
-	u.monitor_red = std::unique_ptr<tools::Monitor_BFER_reduction>(new tools::Monitor_BFER_reduction(u.monitors));
-	u.monitor_red->set_reduce_frequency(std::chrono::milliseconds(500));
-	// create a sigma noise type
-	u.noise = std::unique_ptr<tools::Sigma<>>(new tools::Sigma<>());
-	// report the noise values (Es/N0 and Eb/N0)
-	u.reporters.push_back(std::unique_ptr<tools::Reporter>(new tools::Reporter_noise<>(*u.noise)));
-	// report the bit/frame error rates
-	u.reporters.push_back(std::unique_ptr<tools::Reporter>(new tools::Reporter_BFER<>(*u.monitor_red)));
-	// report the simulation throughputs
-	u.reporters.push_back(std::unique_ptr<tools::Reporter>(new tools::Reporter_throughput<>(*u.monitor_red)));
-	// create a terminal that will display the collected data from the reporters
-	u.terminal = std::unique_ptr<tools::Terminal>(p.terminal->build(u.reporters));
-
-	u.modules_stats.resize(u.modules[0].size());
+	for (auto &pt : u.points)
+	{
+		// allocate a common monitor module to reduce all the monitors of the SNR point
+		pt.monitor_red = std::unique_ptr<tools::Monitor_BFER_reduction>(new tools::Monitor_BFER_reduction(pt.monitors));
+		pt.monitor_red->set_reduce_frequency(std::chrono::milliseconds(500));
+		// count the frame errors per thread, the exact reduction is done by one thread every 500 ms
+		std::vector<module::Monitor_BFER<>*> monitors;
+		for (auto &mnt : pt.monitors)
+			monitors.push_back(mnt.get());
+		pt.fe_counter = std::unique_ptr<tools::Monitor_BFER_counter<>>(new tools::Monitor_BFER_counter<>(
+			*pt.monitor_red, monitors, p.monitor->n_frame_errors, std::chrono::milliseconds(500)));
+		// create a sigma noise type
+		pt.noise = std::unique_ptr<tools::Sigma<>>(new tools::Sigma<>());
+		pt.noise->set_values(pt.sigma, pt.ebn0, pt.esn0);
+		// report the noise values (Es/N0 and Eb/N0)
+		pt.reporters.push_back(std::unique_ptr<tools::Reporter>(new tools::Reporter_noise<>(*pt.noise)));
+		// report the bit/frame error rates
+		pt.reporters.push_back(std::unique_ptr<tools::Reporter>(new tools::Reporter_BFER<>(*pt.monitor_red)));
+		// report the simulation throughputs
+		pt.reporters.push_back(std::unique_ptr<tools::Reporter>(new tools::Reporter_throughput<>(*pt.monitor_red)));
+		// create a terminal that will display the collected data from the reporters
+		pt.terminal = std::unique_ptr<tools::Terminal>(p.terminal->build(pt.reporters));
+	}
+
+	u.scheduler = std::unique_ptr<tools::SNR_scheduler>(new tools::SNR_scheduler(u.points.size()));
+	u.terminal  = std::unique_ptr<tools::Terminal>(new tools::Terminal_std(std::vector<tools::Reporter*>()));
+
+	// the monitors of all the SNR points are gathered in the last line of the statistics
+	u.modules_stats.resize(u.modules[0].size() +1);
 	for (size_t m = 0; m < u.modules[0].size(); m++)
 		for (size_t t = 0; t < u.modules.size(); t++)
 			u.modules_stats[m].push_back(u.modules[t][m]);
-}
\ No newline at end of file
+	for (auto &pt : u.points)
+		for (auto &mnt : pt.monitors)
+			u.modules_stats.back().push_back(mnt.get());
+}
+
+void report(snr_point &pt)
+{
+// the reports of the SNR points are displayed one by one (the lines are not sorted by SNR)
+#pragma omp critical
+{
+	// final reduction
+	pt.monitor_red->reduce();
+
+	// display the performance (BER and FER) in the terminal
+	pt.terminal->final_report();
+}
+}
@@ -0,0 +1,64 @@
+#ifndef MONITOR_BFER_LIMIT_HPP_
+#define MONITOR_BFER_LIMIT_HPP_
+
+#include <cstddef>
+#include <string>
+
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace module
+{
+/*
+ * 'Monitor_BFER' that only analyzes the 'max_n_frames' first frames (0 = no
+ * limit) and ignores the next ones, e.g. the frames that pad the last batch
+ * of a 'Pipeline' (see 'Pipeline::set_n_frames') when the source stops in the
+ * middle of it ('Source_mmap' at the end of its file).
+ *
+ * The frames are counted in the order of the calls: only one clone should be
+ * executed (e.g. in a sequential pipeline stage).
+ */
+template <typename B = int>
+class Monitor_BFER_limit : public Monitor_BFER<B>
+{
+protected:
+	const size_t max_n_frames;
+	size_t       n_frames_seen;
+
+public:
+	Monitor_BFER_limit(const int K, const unsigned max_fe, const size_t max_n_frames)
+	: Monitor_BFER<B>(K, max_fe), max_n_frames(max_n_frames), n_frames_seen(0)
+	{
+		const std::string name = "Monitor_BFER_limit";
+		this->set_name(name);
+	}
+
+	virtual ~Monitor_BFER_limit() = default;
+
+	virtual Monitor_BFER_limit<B>* clone() const
+	{
+		auto m = new Monitor_BFER_limit<B>(*this);
+		m->deep_copy(*this);
+		return m;
+	}
+
+	virtual void reset()
+	{
+		Monitor_BFER<B>::reset();
+		this->n_frames_seen = 0;
+	}
+
+protected:
+	virtual int _check_errors(const B *U, const B *V, const size_t frame_id)
+	{
+		if (this->max_n_frames && this->n_frames_seen >= this->max_n_frames)
+			return 0;
+		this->n_frames_seen++;
+		return Monitor_BFER<B>::_check_errors(U, V, frame_id);
+	}
+};
+}
+}
+
+#endif /* MONITOR_BFER_LIMIT_HPP_ */
@@ -0,0 +1,161 @@
+#ifndef SINK_BATCH_HPP_
+#define SINK_BATCH_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cerrno>
+#include <memory>
+#include <vector>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace module
+{
+/*
+ * Sink that writes the frames as packed bits (same format as 'Source_mmap':
+ * 'K' bits per frame, contiguous, LSB first in each byte) by batches of
+ * 'batch_size' bytes: one 'write' system call per batch instead of a stream
+ * write per frame. The last incomplete batch is written by 'flush', 'reset'
+ * and the destructor. Only the 'max_n_frames' first frames are written (0 = no
+ * limit): the frames that pad the last batch of a pipeline after the end of
+ * the input ('Source_mmap::get_n_frames_file') are not added to the file.
+ *
+ * The clones share the file and have their own batch: only one clone should
+ * be executed (e.g. in a sequential pipeline stage). POSIX only.
+ */
+template <typename B = int>
+class Sink_batch : public Sink<B>, public tools::Interface_reset
+{
+protected:
+	struct File
+	{
+		const std::string path;
+		int               fd;
+
+		explicit File(const std::string &path)
+		: path(path), fd(-1)
+		{
+#if defined(__unix__) || defined(__APPLE__)
+			this->fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if (this->fd == -1)
+				throw tools::runtime_error(__FILE__, __LINE__, __func__, "Can't open the '" + path + "' file.");
+#else
+			throw tools::runtime_error(__FILE__, __LINE__, __func__, "'Sink_batch' requires a POSIX system.");
+#endif
+		}
+
+		~File()
+		{
+#if defined(__unix__) || defined(__APPLE__)
+			if (this->fd != -1)
+				::close(this->fd);
+#endif
+		}
+
+		File(const File&) = delete;
+		File& operator=(const File&) = delete;
+
+		void write(const uint8_t *data, size_t n_bytes)
+		{
+#if defined(__unix__) || defined(__APPLE__)
+			while (n_bytes)
+			{
+				const auto n = ::write(this->fd, data, n_bytes);
+				if (n == -1 && errno == EINTR)
+					continue;
+				if (n <= 0)
+					throw tools::runtime_error(__FILE__, __LINE__, __func__, "Can't write in the '" + this->path +
+					                                                         "' file.");
+				data    += n;
+				n_bytes -= (size_t)n;
+			}
+#else
+			(void)data; (void)n_bytes;
+#endif
+		}
+	};
+
+	std::shared_ptr<File> file;
+	const size_t          batch_size; // in bytes
+	std::vector<uint8_t>  batch;      // packed bits not written yet (+ the last incomplete byte)
+	size_t                n_bits;     // number of bits in 'batch'
+	const size_t          max_n_frames;
+	size_t                n_frames_sent;
+
+public:
+	Sink_batch(const int K, const std::string &path, const size_t max_n_frames = 0,
+	           const size_t batch_size = (size_t)8 << 20)
+	: Sink<B>(K),
+	  file(new File(path)),
+	  batch_size(std::max(batch_size, (size_t)K / 8 +1)),
+	  batch(this->batch_size + (size_t)K / 8 +2, 0),
+	  n_bits(0),
+	  max_n_frames(max_n_frames),
+	  n_frames_sent(0)
+	{
+		const std::string name = "Sink_batch";
+		this->set_name(name);
+		this->set_short_name(name);
+	}
+
+	virtual ~Sink_batch()
+	{
+		try { this->flush(); } catch (...) {}
+	}
+
+	virtual Sink_batch<B>* clone() const
+	{
+		auto m = new Sink_batch<B>(*this);
+		m->deep_copy(*this);
+		m->n_bits = 0;
+		std::fill(m->batch.begin(), m->batch.end(), 0);
+		return m;
+	}
+
+	// writes all the bits (the last byte is padded with zeros)
+	void flush()
+	{
+		this->file->write(this->batch.data(), (this->n_bits + 7) / 8);
+		std::fill(this->batch.begin(), this->batch.end(), 0);
+		this->n_bits = 0;
+	}
+
+	virtual void reset()
+	{
+		this->flush();
+	}
+
+protected:
+	void _send(const B *V, const size_t /*frame_id*/)
+	{
+		if (this->max_n_frames && this->n_frames_sent >= this->max_n_frames)
+			return;
+		this->n_frames_sent++;
+
+		for (size_t i = 0; i < (size_t)this->K; i++, this->n_bits++)
+			this->batch[this->n_bits >> 3] |= (uint8_t)((V[i] ? 1 : 0) << (this->n_bits & 7));
+
+		// write the complete bytes, the incomplete one is moved at the beginning of the batch
+		const size_t n_bytes = this->n_bits / 8;
+		if (n_bytes >= this->batch_size)
+		{
+			this->file->write(this->batch.data(), n_bytes);
+			const uint8_t last = this->batch[n_bytes];
+			std::fill(this->batch.begin(), this->batch.begin() + n_bytes +1, 0);
+			this->batch[0] = last;
+			this->n_bits  -= n_bytes * 8;
+		}
+	}
+};
+}
+}
+
+#endif /* SINK_BATCH_HPP_ */
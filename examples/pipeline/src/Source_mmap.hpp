@@ -0,0 +1,195 @@
+#ifndef SOURCE_MMAP_HPP_
+#define SOURCE_MMAP_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace module
+{
+/*
+ * Source that replays a file of packed bits ('K' bits per frame, contiguous,
+ * LSB first in each byte) through a read-only memory mapping of the whole
+ * file: there is no read call and no copy in an intermediate buffer. The
+ * kernel is asked to read ahead the next 'prefetch' bytes asynchronously
+ * ('madvise(MADV_WILLNEED)') and the consumed part is released, so files much
+ * larger than the memory can be replayed at the speed of the mapping.
+ *
+ * The clones share the mapping but each one has its own position: each clone
+ * replays the file from its first frame, so the source has to be executed by
+ * only one thread (e.g. a sequential pipeline stage). Once the file is over,
+ * the frames are zeros: they pad the last batch of 'Pipeline::set_n_frames'
+ * when 'get_n_frames_file' is not a multiple of the batch size, limit the
+ * consumers to 'get_n_frames_file' frames to ignore them. POSIX only.
+ */
+template <typename B = int>
+class Source_mmap : public Source<B>, public tools::Interface_reset
+{
+protected:
+	struct Mapping
+	{
+		const uint8_t *data;
+		size_t         n_bytes;
+
+		explicit Mapping(const std::string &path)
+		: data(nullptr), n_bytes(0)
+		{
+#if defined(__unix__) || defined(__APPLE__)
+			const int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd == -1)
+				throw tools::runtime_error(__FILE__, __LINE__, __func__, "Can't open the '" + path + "' file.");
+			struct stat st;
+			if (::fstat(fd, &st) == -1 || st.st_size == 0)
+			{
+				::close(fd);
+				throw tools::runtime_error(__FILE__, __LINE__, __func__, "The '" + path + "' file is empty.");
+			}
+			this->n_bytes = (size_t)st.st_size;
+			void *ptr = ::mmap(nullptr, this->n_bytes, PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd); // the mapping keeps the file open
+			if (ptr == MAP_FAILED)
+				throw tools::runtime_error(__FILE__, __LINE__, __func__, "Can't map the '" + path + "' file.");
+			::madvise(ptr, this->n_bytes, MADV_SEQUENTIAL);
+			this->data = static_cast<const uint8_t*>(ptr);
+#else
+			throw tools::runtime_error(__FILE__, __LINE__, __func__, "'Source_mmap' requires a POSIX system.");
+#endif
+		}
+
+		~Mapping()
+		{
+#if defined(__unix__) || defined(__APPLE__)
+			if (this->data != nullptr)
+				::munmap(const_cast<uint8_t*>(this->data), this->n_bytes);
+#endif
+		}
+
+		Mapping(const Mapping&) = delete;
+		Mapping& operator=(const Mapping&) = delete;
+	};
+
+	std::shared_ptr<const Mapping> mapping;
+	const size_t                   n_frames_file; // number of complete frames in the file
+	const bool                     auto_reset;    // replay the file from the beginning when it is over
+	const size_t                   prefetch;      // read ahead size (in bytes, a multiple of 1 MB)
+	size_t                         next_frame;
+	size_t                         prefetched;    // the bytes before this offset have been prefetched
+	size_t                         released;      // the bytes before this offset have been released
+	bool                           done;
+
+public:
+	Source_mmap(const int K, const std::string &path, const bool auto_reset = false,
+	            const size_t prefetch = (size_t)64 << 20)
+	: Source<B>(K),
+	  mapping(new Mapping(path)),
+	  n_frames_file((this->mapping->n_bytes * 8) / (size_t)K),
+	  auto_reset(auto_reset),
+	  prefetch(((std::max(prefetch, (size_t)1) + ((size_t)1 << 20) -1) >> 20) << 20), // multiple of 1 MB (pages)
+	  next_frame(0),
+	  prefetched(0),
+	  released(0),
+	  done(false)
+	{
+		const std::string name = "Source_mmap";
+		this->set_name(name);
+		this->set_short_name(name);
+
+		if (this->n_frames_file == 0)
+			throw tools::invalid_argument(__FILE__, __LINE__, __func__, "The '" + path + "' file does not contain a "
+			                                                             "complete frame of 'K' bits.");
+	}
+
+	virtual ~Source_mmap() = default;
+
+	virtual Source_mmap<B>* clone() const
+	{
+		auto m = new Source_mmap<B>(*this);
+		m->deep_copy(*this);
+		return m;
+	}
+
+	virtual bool is_done() const
+	{
+		return this->done;
+	}
+
+	virtual void reset()
+	{
+		this->next_frame = 0;
+		this->prefetched = 0;
+		this->released   = 0;
+		this->done       = false;
+	}
+
+	size_t get_n_frames_file() const { return this->n_frames_file; }
+
+protected:
+	void _generate(B *U_K, const size_t /*frame_id*/)
+	{
+		if (this->done)
+		{
+			std::fill(U_K, U_K + this->K, (B)0);
+			return;
+		}
+
+		const auto   data  = this->mapping->data;
+		const size_t first = this->next_frame * (size_t)this->K; // index of the first bit of the frame
+		this->advise(first / 8);
+
+		for (size_t i = 0; i < (size_t)this->K; i++)
+		{
+			const size_t bit = first + i;
+			U_K[i] = (B)((data[bit >> 3] >> (bit & 7)) & 1);
+		}
+
+		if (++this->next_frame == this->n_frames_file)
+		{
+			if (this->auto_reset)
+				this->reset();
+			else
+				this->done = true;
+		}
+	}
+
+	// asynchronous read ahead of the next chunk and release of the previous ones (by chunks of 'prefetch' bytes)
+	void advise(const size_t offset)
+	{
+#if defined(__unix__) || defined(__APPLE__)
+		const auto   base    = const_cast<uint8_t*>(this->mapping->data);
+		const size_t n_bytes = this->mapping->n_bytes;
+		const size_t page    = (size_t)::sysconf(_SC_PAGESIZE);
+
+		if (offset + this->prefetch / 2 >= this->prefetched && this->prefetched < n_bytes)
+		{
+			const size_t len = std::min(this->prefetch, n_bytes - this->prefetched);
+			::madvise(base + this->prefetched, len, MADV_WILLNEED);
+			this->prefetched += len;
+		}
+
+		if (offset >= this->released + 2 * this->prefetch)
+		{
+			const size_t len = ((offset - this->released - this->prefetch) / page) * page;
+			::madvise(base + this->released, len, MADV_DONTNEED);
+			this->released += len;
+		}
+#else
+		(void)offset;
+#endif
+	}
+};
+}
+}
+
+#endif /* SOURCE_MMAP_HPP_ */
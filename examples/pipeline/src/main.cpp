@@ -9,15 +9,38 @@
 #include <string>
 #include <thread>
 #include <random>
+#include <cmath>
+#include <numeric>
+#include <chrono>
 
 #include <aff3ct.hpp>
 using namespace aff3ct;
 
+#include "Thread_placement.hpp"
+#include "Stats_export.hpp"
+#include "Source_mmap.hpp"
+#include "Sink_batch.hpp"
+#include "Monitor_BFER_limit.hpp"
+#include "Metrics_endpoint.hpp"
+
 struct params
 {
-	size_t n_threads = std::thread::hardware_concurrency();
-	float  ebn0      = 20.00f; // SNR value
-	float  R;                  // code rate (R=K/N)
+	size_t n_threads      = std::thread::hardware_concurrency();
+	size_t n_calib_frames = 1000;   // number of frames of the calibration phase (0 = no calibration)
+	size_t n_frames       = 8;      // number of frames moved per synchronization between the stages
+	size_t buffer_size    = 1024;   // synchronization buffer size between the stages (in frames)
+	std::string waiting   = "AUTO"; // waiting between the stages: "ACTIVE", "PASSIVE" or "AUTO"
+	// threads pinning: "NONE", "COMPACT", "SCATTER", "STAGE_SOCKET" (one socket per stage) or a list of PUIDs "0,2,..."
+	std::string thread_placement = "NONE";
+	std::string stats_path = "stats"; // export the task statistics in 'stats_path'.json and .csv ("" = no export)
+	std::string input_path  = ""; // replay the frames of this file with 'Source_mmap' ("" = source of the factory)
+	std::string output_path = ""; // write the decoded frames in this file with 'Sink_batch' ("" = sink of the factory)
+	int    metrics_port   = 0;      // serve the live metrics on this HTTP port (Prometheus format, 0 = disabled)
+	float  ebn0           = 20.00f; // SNR value
+	float  R;                       // code rate (R=K/N)
+
+	// number of threads per pipeline stage (stage 1 is sized by the calibration, if enabled)
+	std::vector<size_t> stage_threads;
 
 	std::unique_ptr<factory::Source          > source;
 	std::unique_ptr<factory::Codec_repetition> codec;
@@ -41,15 +64,19 @@ struct modules
 	                module::Decoder_SIHO<>* decoder;
 };
 void init_modules(const params &p, modules &m);
+void calibrate_stages(params &p, const modules &m, tools::Sigma<> &noise, const std::vector<float> &sigma,
+                      const float esn0);
 
 struct utils
 {
-	            std::unique_ptr<tools::Sigma<>  > noise;     // a sigma noise type
-	std::vector<std::unique_ptr<tools::Reporter>> reporters; // list of reporters displayed in the terminal
-	            std::unique_ptr<tools::Terminal > terminal;  // manage the output text in the terminal
-	            std::unique_ptr<tools::Pipeline>  pipeline;
+	            std::unique_ptr<tools::Sigma<>          > noise;     // a sigma noise type
+	std::vector<std::unique_ptr<tools::Reporter        >> reporters; // list of reporters displayed in the terminal
+	            std::unique_ptr<tools::Terminal         > terminal;  // manage the output text in the terminal
+	            std::unique_ptr<tools::Pipeline         > pipeline;
+	            std::unique_ptr<tools::Metrics_endpoint > metrics;   // serve the live metrics over HTTP (if enabled)
 };
 void init_utils(const params &p, const modules &m, utils &u);
+void init_metrics(const params &p, const modules &m, utils &u);
 
 int main(int argc, char** argv)
 {
@@ -82,7 +109,19 @@ int main(int argc, char** argv)
 	(*m.channel)[chn::sck::add_noise ::CP].bind(sigma);
 	(*m.modem  )[mdm::sck::demodulate::CP].bind(sigma);
 
-	utils u; init_utils(p, m, u); // create and initialize the utils
+	// compute the current sigma for the channel noise
+	const auto esn0 = tools::ebn0_to_esn0(p.ebn0, p.R, p.modem->bps);
+	std::fill(sigma.begin(), sigma.end(), tools::esn0_to_sigma(esn0, p.modem->cpm_upf));
+
+	// create a sigma noise type (before the calibration: the codec keeps a reference on it)
+	utils u;
+	u.noise = std::unique_ptr<tools::Sigma<>>(new tools::Sigma<>());
+
+	// measure the cost of the stages on the current code and SNR to size them (before the pipeline clones the modules)
+	if (p.n_calib_frames)
+		calibrate_stages(p, m, *u.noise, sigma, esn0);
+
+	init_utils(p, m, u); // create and initialize the utils
 
 	// set the noise
 	m.codec->set_noise(*u.noise);
@@ -99,29 +138,42 @@ int main(int argc, char** argv)
 	for (auto &m : u.pipeline->get_modules<tools::Interface_set_seed>())
 		m->set_seed(prng());
 
-	// compute the current sigma for the channel noise
-	const auto esn0 = tools::ebn0_to_esn0(p.ebn0, p.R, p.modem->bps);
-	std::fill(sigma.begin(), sigma.end(), tools::esn0_to_sigma(esn0, p.modem->cpm_upf));
-
 	u.noise->set_values(sigma[0], p.ebn0, esn0);
 
 	// display the performance (BER and FER) in real time (in a separate thread)
 	u.terminal->legend();
 	u.terminal->start_temp_report();
 
+	if (u.metrics)
+	{
+		u.metrics->start();
+		std::cout << "# Live metrics served on http://localhost:" << u.metrics->get_port() << "/metrics" << std::endl;
+	}
+
 	// will automatically stop when `m.source->is_done()` will be `true` (end of input file) or if user press `Ctrl+c`
 	u.pipeline->exec([&u]() { return u.terminal->is_interrupt(); });
 
 	// display the performance (BER and FER) in the terminal
 	u.terminal->final_report();
+	if (u.metrics)
+		u.metrics->stop();
 
 	// display the statistics of the tasks (if enabled)
 	auto stages = u.pipeline->get_stages();
+	tools::Stats_export stats;
 	for (size_t s = 0; s < stages.size(); s++)
 	{
 		const int n_threads = stages[s]->get_n_threads();
 		std::cout << "#" << std::endl << "# Pipeline stage " << s << " (" << n_threads << " thread(s)): " << std::endl;
 		tools::Stats::show(stages[s]->get_tasks_per_types(), true);
+		stats.add_tasks(stages[s]->get_tasks_per_types(), s);
+	}
+	if (!p.stats_path.empty())
+	{
+		stats.save(p.stats_path + ".json");
+		stats.save(p.stats_path + ".csv");
+		std::cout << "#" << std::endl << "# Statistics exported in '" << p.stats_path << ".json' and '"
+		          << p.stats_path << ".csv'" << std::endl;
 	}
 	std::cout << "#" << std::endl << "# End of the simulation" << std::endl;
 
@@ -158,22 +210,123 @@ void init_params(int argc, char** argv, params &p)
 	cp.print_warnings();
 
 	p.R = (float)p.codec->enc->K / (float)p.codec->enc->N_cw; // compute the code rate
+
+	p.stage_threads = { 1, p.n_threads ? p.n_threads : 1, 1 };
 }
 
 void init_modules(const params &p, modules &m)
 {
-	m.source  = std::unique_ptr<module::Source      <>>(p.source ->build());
 	m.codec   = std::unique_ptr<tools ::Codec_SIHO  <>>(p.codec  ->build());
 	m.modem   = std::unique_ptr<module::Modem       <>>(p.modem  ->build());
 	m.channel = std::unique_ptr<module::Channel     <>>(p.channel->build());
-	m.monitor = std::unique_ptr<module::Monitor_BFER<>>(p.monitor->build());
-	m.sink    = std::unique_ptr<module::Sink        <>>(p.sink   ->build());
+
+	// the packed bits files are memory-mapped (stage 0) and written by batches (stage 2)
+	const int K = p.codec->enc->K;
+	size_t n_frames_file = 0; // the frames after the end of the input file only pad the last batch of the pipeline
+	if (p.input_path.empty())
+		m.source = std::unique_ptr<module::Source<>>(p.source->build());
+	else
+	{
+		auto source = new module::Source_mmap<>(K, p.input_path);
+		n_frames_file = source->get_n_frames_file();
+		m.source = std::unique_ptr<module::Source<>>(source);
+	}
+	if (p.output_path.empty())
+		m.sink = std::unique_ptr<module::Sink<>>(p.sink->build());
+	else
+		m.sink = std::unique_ptr<module::Sink<>>(new module::Sink_batch<>(K, p.output_path, n_frames_file));
+
+	// the padding frames are not analyzed
+	if (n_frames_file)
+		m.monitor = std::unique_ptr<module::Monitor_BFER<>>(
+			new module::Monitor_BFER_limit<>(K, p.monitor->n_frame_errors, n_frames_file));
+	else
+		m.monitor = std::unique_ptr<module::Monitor_BFER<>>(p.monitor->build());
+
 	m.encoder = &m.codec->get_encoder();
 	m.decoder = &m.codec->get_decoder_siho();
 }
 
+void calibrate_stages(params &p, const modules &m, tools::Sigma<> &noise, const std::vector<float> &sigma,
+                      const float esn0)
+{
+	using namespace module;
+
+	// the tasks of each stage, the sink is not run (no output during the calibration)
+	const std::vector<std::vector<Task*>> stages =
+	{
+		{ &(*m.source )[src::tsk::generate    ] },
+		{ &(*m.encoder)[enc::tsk::encode      ], &(*m.modem  )[mdm::tsk::modulate  ],
+		  &(*m.channel)[chn::tsk::add_noise   ], &(*m.modem  )[mdm::tsk::demodulate],
+		  &(*m.decoder)[dec::tsk::decode_siho ] },
+		{ &(*m.monitor)[mnt::tsk::check_errors] },
+	};
+
+	noise.set_values(sigma[0], p.ebn0, esn0);
+	m.codec->set_noise(noise);
+
+	for (auto &stage : stages) for (auto &tsk : stage)
+	{
+		tsk->reset();
+		tsk->set_stats(true);
+	}
+
+	// run the chain sequentially on the original modules
+	for (size_t f = 0; f < p.n_calib_frames; f++)
+		for (auto &stage : stages) for (auto &tsk : stage)
+			tsk->exec();
+
+	std::vector<double> cost(stages.size(), 0.); // average time per frame in each stage (in ns)
+	for (size_t s = 0; s < stages.size(); s++)
+		for (auto &tsk : stages[s])
+			cost[s] += (double)tsk->get_duration_total().count() / (double)p.n_calib_frames;
+
+	// stages 0 and 2 are sequential (1 thread): above this width, stage 1 is not the bottleneck anymore
+	const auto seq_cost = std::max(std::max(cost[0], cost[2]), 1.);
+	const auto n_max    = p.n_threads ? p.n_threads : 1;
+	const auto n_stage1 = std::min(n_max, std::max((size_t)1, (size_t)std::ceil(cost[1] / seq_cost)));
+	p.stage_threads = { 1, n_stage1, 1 };
+
+	std::cout << "# Calibration (" << p.n_calib_frames << " frames): average time per frame = " << cost[0] << " ns | "
+	          << cost[1] << " ns | " << cost[2] << " ns (stages 0 | 1 | 2)" << std::endl;
+	std::cout << "#  -> number of threads per stage = " << p.stage_threads[0] << " | " << p.stage_threads[1] << " | "
+	          << p.stage_threads[2] << std::endl;
+	std::cout << "#" << std::endl;
+
+	// forget the calibration frames
+	for (auto &stage : stages) for (auto &tsk : stage)
+		tsk->reset();
+	m.monitor->reset();
+	auto src_reset = dynamic_cast<tools::Interface_reset*>(m.source.get());
+	if (src_reset != nullptr)
+		src_reset->reset();
+}
+
 void init_utils(const params &p, const modules &m, utils &u)
 {
+	// the buffers contain batches of 'n_frames' frames: keep the same memory footprint
+	const size_t n_frames    = p.n_frames ? p.n_frames : 1;
+	const size_t buffer_size = std::max((size_t)1, p.buffer_size / n_frames);
+
+	if (p.waiting != "ACTIVE" && p.waiting != "PASSIVE" && p.waiting != "AUTO")
+		throw tools::invalid_argument(__FILE__, __LINE__, __func__, "Unknown waiting type ('p.waiting' = " +
+		                              p.waiting + ").");
+
+	// each clone of 'Source_mmap' would replay the file from its first frame and each clone of 'Sink_batch' (or of
+	// 'Monitor_BFER_limit') would count its own frames: these stages have to be sequential
+	if ((!p.input_path.empty() || !p.output_path.empty()) && (p.stage_threads[0] != 1 || p.stage_threads[2] != 1))
+		throw tools::invalid_argument(__FILE__, __LINE__, __func__, "'Source_mmap' and 'Sink_batch' require one thread "
+		                              "in the stages 0 and 2.");
+
+	// active waiting has the lowest latency but each waiting thread spins on its core: in "AUTO" mode it is only
+	// enabled when there is a core for each thread of the pipeline
+	const size_t n_pipeline_threads = std::accumulate(p.stage_threads.begin(), p.stage_threads.end(), (size_t)0);
+	const bool active_waiting = p.waiting == "ACTIVE" ||
+	                           (p.waiting == "AUTO" && n_pipeline_threads <= std::thread::hardware_concurrency());
+
+	// the threads of each stage are pinned before cloning the modules (first-touch allocation on their NUMA node)
+	const tools::Thread_placement placement(p.thread_placement);
+
 	u.pipeline.reset(new tools::Pipeline((*m.source)[module::src::tsk::generate], // first task of the sequence
 	                                     { // pipeline stage 0
 	                                       { { &(*m.source )[module::src::tsk::generate    ] },   // first tasks of stage 0
@@ -187,24 +340,27 @@ void init_utils(const params &p, const modules &m, utils &u)
 	                                         { /* empty vector of last tasks */              } }, // last  tasks of stage 2
 	                                     },
 	                                     {
-	                                       1,                             // number of threads in the stage 0
-	                                       p.n_threads ? p.n_threads : 1, // number of threads in the stage 1
-	                                       1                              // number of threads in the stage 2
+	                                       p.stage_threads[0], // number of threads in the stage 0
+	                                       p.stage_threads[1], // number of threads in the stage 1
+	                                       p.stage_threads[2]  // number of threads in the stage 2
 	                                     },
 	                                     {
-	                                       1024, // synchronization buffer size between stages 0 and 1
-	                                       1024, // synchronization buffer size between stages 1 and 2
+	                                       buffer_size, // synchronization buffer size between stages 0 and 1
+	                                       buffer_size, // synchronization buffer size between stages 1 and 2
 	                                     },
 	                                     {
-	                                       false, // type of waiting between stages 0 and 1 (true = active, false = passive)
-	                                       false, // type of waiting between stages 1 and 2 (true = active, false = passive)
-	                                     }));
+	                                       active_waiting, // type of waiting between stages 0 and 1 (true = active, false = passive)
+	                                       active_waiting, // type of waiting between stages 1 and 2 (true = active, false = passive)
+	                                     },
+	                                     placement.get_pinning(p.stage_threads.size()), // thread pinning per stage
+	                                     placement.get_puids  (p.stage_threads       ))); // PUIDs per stage
+
+	// each task processes (and each synchronization moves) 'n_frames' frames at once
+	u.pipeline->set_n_frames(p.n_frames ? p.n_frames : 1);
 
 	std::ofstream f("pipeline.dot");
 	u.pipeline->export_dot(f);
 
-	// create a sigma noise type
-	u.noise = std::unique_ptr<tools::Sigma<>>(new tools::Sigma<>());
 	// report the noise values (Es/N0 and Eb/N0)
 	u.reporters.push_back(std::unique_ptr<tools::Reporter>(new tools::Reporter_noise<>(*u.noise)));
 	// report the bit/frame error rates
@@ -225,4 +381,47 @@ void init_utils(const params &p, const modules &m, utils &u)
 		if (!tsk->is_debug() && !tsk->is_stats())
 			tsk->set_fast(true);
 	}
-}
\ No newline at end of file
+
+	if (p.metrics_port)
+		init_metrics(p, m, u);
+}
+
+void init_metrics(const params &p, const modules &m, utils &u)
+{
+	u.metrics.reset(new tools::Metrics_endpoint(p.metrics_port));
+	const auto &mnt = *m.monitor;
+
+	// the same counters as the reporters of the terminal
+	const auto ebn0 = (double)p.ebn0;
+	u.metrics->add("aff3ct_ebn0_db", "gauge", "Current Eb/N0 (dB).", [ebn0]() { return ebn0; });
+	u.metrics->add("aff3ct_frames_total", "counter", "Number of analyzed frames.",
+	               [&mnt]() { return (double)mnt.get_n_analyzed_fra(); });
+	u.metrics->add("aff3ct_frame_errors_total", "counter", "Number of frame errors.",
+	               [&mnt]() { return (double)mnt.get_n_fe(); });
+	u.metrics->add("aff3ct_bit_errors_total", "counter", "Number of bit errors.",
+	               [&mnt]() { return (double)mnt.get_n_be(); });
+	u.metrics->add("aff3ct_fer", "gauge", "Frame error rate.",
+	               [&mnt]() { return mnt.get_n_analyzed_fra() ? (double)mnt.get_fer() : 0.; });
+	u.metrics->add("aff3ct_ber", "gauge", "Bit error rate.",
+	               [&mnt]() { return mnt.get_n_analyzed_fra() ? (double)mnt.get_ber() : 0.; });
+
+	// average information throughput since the start of the simulation (as 'Reporter_throughput')
+	const auto K       = (double)p.codec->enc->K;
+	const auto t_start = std::chrono::steady_clock::now();
+	u.metrics->add("aff3ct_throughput_mbps", "gauge", "Average information throughput (Mb/s).", [&mnt, K, t_start]()
+	{
+		const auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+		                                                                      t_start).count();
+		return us ? (double)mnt.get_n_analyzed_fra() * K / (double)us : 0.;
+	});
+
+	// the stages and their tasks (the pipeline does not expose the filling of its synchronization buffers)
+	auto stages = u.pipeline->get_stages();
+	for (size_t s = 0; s < stages.size(); s++)
+	{
+		const auto n_threads = (double)stages[s]->get_n_threads();
+		u.metrics->add("aff3ct_pipeline_stage_threads", "gauge", "Number of threads of the pipeline stage.",
+		               [n_threads]() { return n_threads; }, "stage=\"" + std::to_string(s) + "\"");
+		u.metrics->add_tasks(stages[s]->get_tasks_per_types(), s);
+	}
+}
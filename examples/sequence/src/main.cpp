@@ -13,6 +13,14 @@
 #include <aff3ct.hpp>
 using namespace aff3ct;
 
+#include "Thread_placement.hpp"
+#include "Stats_export.hpp"
+#include "Monitor_BFER_counter.hpp"
+#include "Barrier.hpp"
+#ifdef USE_MPI
+#include "Monitor_BFER_MPI.hpp"
+#endif
+
 //#define STEP_BY_STEP
 
 struct params
@@ -22,6 +30,10 @@ struct params
 #else
 	size_t n_threads = 1;
 #endif
+	std::string thread_placement = "NONE"; // threads pinning: "NONE", "COMPACT", "SCATTER" or a list of PUIDs "0,2,..."
+	std::string stats_path = "stats"; // export the task statistics in 'stats_path'.json and .csv ("" = no export)
+	size_t stats_sampling = 1; // time the tasks of 1 thread every 'stats_sampling' threads (0 = no statistics)
+	bool   persistent = true; // one 'exec' of the sequence for all the SNR points (barrier between the points)
 	float  ebn0_min  =  0.00f; // minimum SNR value
 	float  ebn0_max  = 10.01f; // maximum SNR value
 	float  ebn0_step =  1.00f; // SNR step
@@ -58,12 +70,27 @@ struct utils
 	std::vector<std::unique_ptr<tools::Reporter              >> reporters;   // list of reporters displayed in the terminal
 	            std::unique_ptr<tools::Terminal              >  terminal;    // manage the output text in the terminal
 	            std::unique_ptr<tools::Monitor_BFER_reduction>  monitor_red; // main monitor object that reduce all the thread monitors
+	            std::unique_ptr<tools::Monitor_BFER_counter<>>  fe_counter;  // low contention stop criterion (frame errors)
+#ifdef USE_MPI
+	            std::unique_ptr<tools::Monitor_BFER_MPI<>    >  mpi;         // reduction and stop criterion over the ranks
+#endif
 	            std::unique_ptr<tools::Sequence              >  sequence;
 };
 void init_utils(const params &p, const modules &m, utils &u);
 
 int main(int argc, char** argv)
 {
+	int rank = 0;
+#ifdef USE_MPI
+	// the MPI calls are made by one thread at a time (from the stop condition of the sequence)
+	int provided;
+	MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	// only the rank 0 displays the parameters and the reports (the errors are still displayed on std::cerr)
+	if (rank != 0)
+		std::cout.setstate(std::ios::failbit);
+#endif
+
 	// get the AFF3CT version
 	const std::string v = "v" + std::to_string(tools::version_major()) + "." +
 	                            std::to_string(tools::version_minor()) + "." +
@@ -104,16 +131,31 @@ int main(int argc, char** argv)
 	for (auto &m : u.sequence->get_modules<tools::Interface_notify_noise_update>())
 		u.noise->record_callback_update([m](){ m->notify_noise_update(); });
 
-	// set different seeds in the modules that uses PRNG
-	std::mt19937 prng;
+	// set different seeds in the modules that uses PRNG (and on each rank)
+	std::mt19937 prng(std::mt19937::default_seed + rank);
 	for (auto &m : u.sequence->get_modules<tools::Interface_set_seed>())
 		m->set_seed(prng());
 
 	// display the legend in the terminal
 	u.terminal->legend();
 
-	// loop over the various SNRs
+	std::vector<float> ebn0s; // the SNR points of the sweep
 	for (auto ebn0 = p.ebn0_min; ebn0 < p.ebn0_max; ebn0 += p.ebn0_step)
+		ebn0s.push_back(ebn0);
+
+	// monitor of each thread and its number of frames over the SNR points (to measure the overhead of the statistics)
+	std::vector<module::Monitor_BFER<>*> thread_monitors;
+	for (auto &mods : u.sequence->get_modules_per_threads())
+		for (auto &mod : mods)
+			if (auto mnt = dynamic_cast<module::Monitor_BFER<>*>(mod))
+			{
+				thread_monitors.push_back(mnt);
+				break;
+			}
+	std::vector<unsigned long long> thread_frames(thread_monitors.size(), 0);
+
+	bool in_progress = false; // a SNR point is started and not reported yet
+	auto start_point = [&](const float ebn0)
 	{
 		// compute the current sigma for the channel noise
 		const auto esn0 = tools::ebn0_to_esn0(ebn0, p.R, p.modem->bps);
@@ -123,39 +165,151 @@ int main(int argc, char** argv)
 
 		// display the performance (BER and FER) in real time (in a separate thread)
 		u.terminal->start_temp_report();
+		in_progress = true;
+	};
 
-		// execute the simulation sequence (multi-threaded)
-#ifndef STEP_BY_STEP
-		u.sequence->exec([&u]() { return u.monitor_red->is_done() || u.terminal->is_interrupt(); });
+	// the stop condition of a SNR point
+	auto point_done = [&u]()
+	{
+#ifndef USE_MPI
+		return u.fe_counter->is_done() || u.terminal->is_interrupt();
 #else
-		Task* cur_task;
-		do
-			while ((cur_task = u.sequence->exec_step()));
-			/*{
-				std::cout << "cur_task->get_name() = " << cur_task->get_name() << std::endl;
-			}*/
-		while (!u.sequence->is_done() && !u.monitor_red->is_done() && !u.terminal->is_interrupt());
+		// the ranks stop together, when the frame errors of the cluster reach the limit (or a rank votes to stop)
+		return u.mpi->is_done(u.fe_counter->is_done() || u.terminal->is_interrupt());
 #endif
+	};
+
+	// returns true if the user pressed Ctrl+c twice (exit the SNRs loop)
+	auto end_point = [&]()
+	{
+		// frames of each thread of this rank (before the MPI reduction collects the other ranks in the first monitor)
+		for (size_t t = 0; t < thread_monitors.size(); t++)
+			thread_frames[t] += thread_monitors[t]->get_n_analyzed_fra();
 
 		// final reduction
+#ifndef USE_MPI
 		u.monitor_red->reduce();
+		const bool over = u.terminal->is_over();
+#else
+		const bool over = u.mpi->reduce(u.terminal->is_over()); // over the threads and the ranks (and on all the ranks)
+#endif
 
 		// display the performance (BER and FER) in the terminal
 		u.terminal->final_report();
+		in_progress = false;
 
 		// reset the monitor and the terminal for the next SNR
 		u.monitor_red->reset();
+		u.fe_counter->reset();
+#ifdef USE_MPI
+		u.mpi->reset();
+#endif
 		u.terminal->reset();
 
-		// if user pressed Ctrl+c twice, exit the SNRs loop
-		if (u.terminal->is_over()) break;
+		return over;
+	};
+
+#ifndef STEP_BY_STEP
+	if (p.persistent && !ebn0s.empty())
+	{
+		// one execution of the sequence for all the SNR points: at the end of a point the threads wait at a barrier,
+		// the last one reports the point and starts the next one, then they all resume (no thread is re-spawned)
+		size_t k = 0;
+		tools::Barrier barrier(u.sequence->get_n_threads());
+#ifndef USE_MPI
+		// a thread may leave the sequence without the barrier
+		const std::function<bool()> abort = [&u]() { return u.terminal->is_over(); };
+#else
+		// the ranks stop a point together (Ctrl+c is a stop vote of 'point_done'): a rank never aborts alone
+		const std::function<bool()> abort = nullptr;
+#endif
+		start_point(ebn0s[k]);
+		u.sequence->exec([&]()
+		{
+			try
+			{
+				if (!point_done())
+					return barrier.is_aborted(); // another thread has thrown: leave the sequence
+				return barrier.wait([&]()
+				{
+					if (end_point() || ++k == ebn0s.size())
+						return true;
+					start_point(ebn0s[k]);
+					return false;
+				}, abort);
+			}
+			catch (...)
+			{
+				// this thread will never reach the barrier again: release the others
+				barrier.abort();
+				throw;
+			}
+		});
+		if (in_progress)
+			end_point();
+	}
+	else
+#endif
+	// loop over the various SNRs
+	for (auto ebn0 : ebn0s)
+	{
+		start_point(ebn0);
+
+		// execute the simulation sequence (multi-threaded)
+#ifndef STEP_BY_STEP
+		u.sequence->exec(point_done);
+#else
+		Task* cur_task;
+		do
+			while ((cur_task = u.sequence->exec_step()));
+			/*{
+				std::cout << "cur_task->get_name() = " << cur_task->get_name() << std::endl;
+			}*/
+		while (!u.sequence->is_done() && !u.fe_counter->is_done() && !u.terminal->is_interrupt());
+#endif
+
+		if (end_point()) break;
 	}
 
 	// display the statistics of the tasks (if enabled)
 	std::cout << "#" << std::endl;
 	tools::Stats::show(u.sequence->get_modules_per_types(), true);
+
+	// overhead of the statistics: frames simulated by a timed thread vs. by a fast thread in the same time
+	if (p.stats_sampling > 1 && thread_frames.size() > 1)
+	{
+		double timed = 0., fast = 0.;
+		size_t n_timed = 0;
+		for (size_t t = 0; t < thread_frames.size(); t++)
+		{
+			if (t % p.stats_sampling == 0)
+			{
+				timed += (double)thread_frames[t];
+				n_timed++;
+			}
+			else
+				fast += (double)thread_frames[t];
+		}
+		const auto n_fast = thread_frames.size() - n_timed;
+		if (fast > 0.)
+			std::cout << "# Statistics overhead = " << 100. * (1. - (timed / n_timed) / (fast / n_fast))
+			          << " % (frames per timed thread vs. per fast thread)" << std::endl;
+	}
+
+	if (!p.stats_path.empty() && rank == 0) // the statistics of the rank 0
+	{
+		tools::Stats_export stats;
+		stats.add_modules(u.sequence->get_modules_per_types());
+		stats.save(p.stats_path + ".json");
+		stats.save(p.stats_path + ".csv");
+		std::cout << "# Statistics exported in '" << p.stats_path << ".json' and '" << p.stats_path << ".csv'" << std::endl;
+	}
 	std::cout << "# End of the simulation" << std::endl;
 
+#ifdef USE_MPI
+	MPI_Finalize();
+#endif
+
 	return 0;
 }
 
@@ -202,12 +356,25 @@ void init_modules(const params &p, modules &m)
 
 void init_utils(const params &p, const modules &m, utils &u)
 {
+	// the threads are pinned before cloning the modules (first-touch allocation on their NUMA node)
+	const size_t n_threads = p.n_threads ? p.n_threads : 1;
+	const tools::Thread_placement placement(p.thread_placement);
 	u.sequence = std::unique_ptr<tools::Sequence>(new tools::Sequence((*m.source)[module::src::tsk::generate],
-		p.n_threads ? p.n_threads : 1));
+		n_threads, placement.is_pinning(), placement.get_puids(n_threads)));
 	// allocate a common monitor module to reduce all the monitors
 	u.monitor_red = std::unique_ptr<tools::Monitor_BFER_reduction>(new tools::Monitor_BFER_reduction(
 		u.sequence->get_modules<module::Monitor_BFER<>>()));
 	u.monitor_red->set_reduce_frequency(std::chrono::milliseconds(500));
+	// count the frame errors per thread, the exact reduction is done by one thread every 500 ms
+	u.fe_counter = std::unique_ptr<tools::Monitor_BFER_counter<>>(new tools::Monitor_BFER_counter<>(
+		*u.monitor_red, u.sequence->get_modules<module::Monitor_BFER<>>(), p.monitor->n_frame_errors,
+		std::chrono::milliseconds(500)));
+#ifdef USE_MPI
+	// sum the frame errors of the ranks every 10 ms (non-blocking), the counters of the other ranks are added in the
+	// monitor of the first thread at the end of each SNR point
+	u.mpi = std::unique_ptr<tools::Monitor_BFER_MPI<>>(new tools::Monitor_BFER_MPI<>(*u.monitor_red, *u.fe_counter,
+		*u.sequence->get_modules<module::Monitor_BFER<>>()[0], p.monitor->n_frame_errors, std::chrono::milliseconds(10)));
+#endif
 	// create a sigma noise type
 	u.noise = std::unique_ptr<tools::Sigma<>>(new tools::Sigma<>());
 	// report the noise values (Es/N0 and Eb/N0)
@@ -219,16 +386,21 @@ void init_utils(const params &p, const modules &m, utils &u)
 	// create a terminal that will display the collected data from the reporters
 	u.terminal = std::unique_ptr<tools::Terminal>(p.terminal->build(u.reporters));
 
-	// configuration of the sequence tasks
-	for (auto& mod : u.sequence->get_modules<module::Module>(false))
-		for (auto& tsk : mod->tasks)
-		{
-			tsk->set_debug      (false); // disable the debug mode
-			tsk->set_debug_limit(16   ); // display only the 16 first bits if the debug mode is enabled
-			tsk->set_stats      (true ); // enable the statistics
-
-			// enable the fast mode (= disable the useless verifs in the tasks) if there is no debug and stats modes
-			if (!tsk->is_debug() && !tsk->is_stats())
-				tsk->set_fast(true);
-		}
+	// configuration of the sequence tasks: the statistics are sampled over the threads (not over the executions),
+	// all the tasks of 1 thread every 'stats_sampling' threads are timed and lose the fast mode, the tasks of the
+	// other threads keep the fast mode
+	const auto modules_per_threads = u.sequence->get_modules_per_threads();
+	for (size_t t = 0; t < modules_per_threads.size(); t++)
+		for (auto& mod : modules_per_threads[t])
+			for (auto& tsk : mod->tasks)
+			{
+				const bool sampled = p.stats_sampling && (t % p.stats_sampling == 0);
+				tsk->set_debug      (false  ); // disable the debug mode
+				tsk->set_debug_limit(16     ); // display only the 16 first bits if the debug mode is enabled
+				tsk->set_stats      (sampled); // enable the statistics on the sampled threads
+
+				// enable the fast mode (= disable the useless verifs in the tasks) if there is no debug and stats modes
+				if (!tsk->is_debug() && !tsk->is_stats())
+					tsk->set_fast(true);
+			}
 }
\ No newline at end of file
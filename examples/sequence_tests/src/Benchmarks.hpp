@@ -0,0 +1,551 @@
+#ifndef BENCHMARKS_HPP_
+#define BENCHMARKS_HPP_
+
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include <aff3ct.hpp>
+
+//#define STEP_BY_STEP
+
+/*
+ * Micro-benchmarks of the 'tools::Sequence' scheduler: the tasks are
+ * 'Incrementer' sleeping 'sleep_time_ns' per frame, so the 'theoretical time'
+ * of a benchmark is its total sleep time and the difference with the measured
+ * time is the overhead of the sequence (and of the control flow tasks).
+ */
+namespace bench
+{
+using namespace aff3ct;
+
+struct Params
+{
+	size_t n_threads      = std::thread::hardware_concurrency();
+	size_t n_inter_frames = 1;
+	size_t sleep_time_ns  = 5000;
+	size_t data_length    = 2048;
+	bool   no_copy_mode   = true;
+	bool   stats          = true;
+	size_t n_exec         = 100000; // number of executions of the sequence per thread (before the loops division)
+	bool   verbose        = true;   // display the details and the task statistics
+	bool   export_dot     = true;   // export the sequences in .dot files
+};
+
+struct Result
+{
+	std::string name;
+	Params      params;
+	size_t      limit;            // number of executions of the sequence
+	size_t      n_tasks_per_exec; // number of tasks executed per execution of the sequence
+	float       elapsed_time;     // in ms
+	float       theoretical_time; // in ms
+	float       build_time;       // construction of the sequence (in ms), shared by the results that reuse it
+	bool        passed;           // the computed data are the expected ones
+
+	// relative difference between the measured and the theoretical times (0 if there is no sleep time)
+	float get_drift() const
+	{
+		return this->theoretical_time > 0.f ?
+		       (this->elapsed_time - this->theoretical_time) / this->theoretical_time : 0.f;
+	}
+
+	// time spent outside of the sleeps per executed task (in ns), with 'sleep_time_ns' = 0 this is the dispatch
+	// cost of a task by the sequence (+ the increments of the 'data_length' elements by the incrementers)
+	float get_dispatch_cost() const
+	{
+		const auto n_tasks = (float)this->limit * (float)this->n_tasks_per_exec;
+		return n_tasks > 0.f ?
+		       ((this->elapsed_time - this->theoretical_time) * 1e6f * (float)this->params.n_threads) / n_tasks : 0.f;
+	}
+};
+
+// the modules of a benchmark
+struct Modules
+{
+	module::Initializer<>                               initializer;
+	module::Finalizer  <>                               finalizer;
+	std::vector<std::shared_ptr<module::Incrementer<>>> incs;
+	module::Switcher                                    switcher;
+	module::Switcher                                    switcher2;
+	module::Switcher                                    switchex;
+	module::Iterator                                    iterator;
+	module::Iterator                                    iterator2;
+	module::Controller_static                           controller;
+
+	explicit Modules(const Params &p)
+	: initializer(p.data_length),
+	  finalizer  (p.data_length),
+	  incs       (6),
+	  switcher   (2, p.data_length, typeid(int)),
+	  switcher2  (2, p.data_length, typeid(int)),
+	  switchex   (3, p.data_length, typeid(int)),
+	  iterator   (10),
+	  iterator2  (2)
+	{
+		for (size_t s = 0; s < this->incs.size(); s++)
+		{
+			this->incs[s].reset(new module::Incrementer<>(p.data_length));
+			this->incs[s]->set_ns(p.sleep_time_ns);
+			this->incs[s]->set_custom_name("Inc" + std::to_string(s));
+		}
+		this->switcher2.set_custom_name("Switcher2");
+		this->iterator2.set_custom_name("Iterator2");
+	}
+};
+
+inline void print_title(const std::string &title)
+{
+	std::cout << "###############################################" << std::endl;
+	std::cout << "# " << title << std::string(44 - std::min((size_t)44, title.size()), ' ') << "#" << std::endl;
+	std::cout << "###############################################" << std::endl;
+}
+
+// each thread gets its own initial data: frame 'f' of thread 'tid' is filled with 'tid * n_inter_frames + f'
+inline void init_data(tools::Sequence &sequence, module::Initializer<> &initializer, const size_t n_inter_frames,
+                      const size_t data_length)
+{
+	size_t tid = 0;
+	for (auto cur_initializer : sequence.get_cloned_modules<module::Initializer<>>(initializer))
+	{
+		std::vector<std::vector<int>> init_data(n_inter_frames, std::vector<int>(data_length, 0));
+		for (size_t f = 0; f < n_inter_frames; f++)
+			std::fill(init_data[f].begin(), init_data[f].end(), tid * n_inter_frames +f);
+		cur_initializer->set_init_data(init_data);
+		tid++;
+	}
+}
+
+inline void configure_tasks(tools::Sequence &sequence, const bool stats)
+{
+	for (auto cur_module : sequence.get_modules<tools::Interface_reset>())
+		cur_module->reset();
+
+	// configuration of the sequence tasks
+	for (auto& mod : sequence.get_modules<module::Module>(false)) for (auto& tsk : mod->tasks)
+	{
+		tsk->reset          (     );
+		tsk->set_debug      (false); // disable the debug mode
+		tsk->set_debug_limit(16   ); // display only the 16 first bits if the debug mode is enabled
+		tsk->set_stats      (stats); // enable the statistics
+		tsk->set_fast       (true ); // enable the fast mode (= disable the useless verifs in the tasks)
+	}
+}
+
+inline void export_dot(tools::Sequence &sequence, const std::string &name, const Params &p)
+{
+	if (!p.export_dot) return;
+	std::ofstream file(name + ".dot");
+	sequence.export_dot(file);
+}
+
+// execute the sequence 'limit' times, returns the elapsed time in ms
+inline float run(tools::Sequence &sequence, const unsigned int limit, const size_t n_threads)
+{
+	std::atomic<unsigned int> counter(0);
+	auto t_start = std::chrono::steady_clock::now();
+#ifndef STEP_BY_STEP
+	// execute the sequence (multi-threaded)
+	sequence.exec([&counter, limit]() { return ++counter >= limit; });
+#else
+	do
+		for (size_t tid = 0; tid < n_threads; tid++)
+			while (sequence.exec_step(tid));
+	while (++counter < (limit / n_threads));
+#endif
+	std::chrono::nanoseconds duration = std::chrono::steady_clock::now() - t_start;
+	(void)n_threads;
+
+	return duration.count() / 1000.f / 1000.f;
+}
+
+// number of tasks executed per execution of the sequence (control flow tasks included), counted on a short run
+// with the statistics enabled
+inline size_t count_tasks_per_exec(tools::Sequence &sequence, const size_t n_threads, const bool stats)
+{
+	const auto tasks = sequence.get_modules<module::Module>(false);
+	for (auto& mod : tasks) for (auto& tsk : mod->tasks)
+	{
+		tsk->reset    (    );
+		tsk->set_stats(true);
+		tsk->set_fast (true);
+	}
+
+	const unsigned int limit = 100 * n_threads;
+	run(sequence, limit, n_threads);
+
+	size_t n_calls = 0;
+	for (auto& mod : tasks) for (auto& tsk : mod->tasks)
+	{
+		n_calls += tsk->get_n_calls();
+		tsk->reset    (     );
+		tsk->set_stats(stats);
+		tsk->set_fast (true );
+	}
+
+	// a few more executions than 'limit' can be started by the threads before they stop
+	return (n_calls + limit / 2) / limit;
+}
+
+// verification of the sequence execution: the final data have to be 'n_incs' + the initial data
+inline bool check(tools::Sequence &sequence, module::Finalizer<> &finalizer, const size_t n_inter_frames,
+                  const int n_incs)
+{
+	bool tests_passed = true;
+	int tid = 0;
+	for (auto cur_finalizer : sequence.get_cloned_modules<module::Finalizer<>>(finalizer))
+	{
+		for (size_t f = 0; f < n_inter_frames; f++)
+		{
+			const auto &final_data = cur_finalizer->get_final_data()[f];
+			for (size_t d = 0; d < final_data.size(); d++)
+			{
+				auto expected = n_incs + (int)(tid * n_inter_frames +f);
+				if (final_data[d] != expected)
+				{
+					std::cout << "expected = " << expected << " - obtained = "
+					          << final_data[d] << " (d = " << d << ", tid = " << tid << ")" << std::endl;
+					tests_passed = false;
+				}
+			}
+		}
+		tid++;
+	}
+	return tests_passed;
+}
+
+// modules, sockets binding and sequence of a micro-benchmark: they depend only on the number of threads and on the
+// data length, so they are built once and reused for the other parameters (inter frames, copy mode and sleep time)
+struct Bench
+{
+	Modules                          m;
+	std::unique_ptr<tools::Sequence> sequence;
+	float                            build_time; // in ms
+
+	explicit Bench(const Params &p) : m(p), build_time(0.f) {}
+};
+
+// build the sequence of the 'b.m' modules (once bound), the construction clones the modules for the threads
+inline void build(Bench &b, const std::string &name, const Params &p)
+{
+	auto t_start = std::chrono::steady_clock::now();
+	b.sequence.reset(new tools::Sequence(b.m.initializer[module::ini::tsk::initialize], p.n_threads));
+	std::chrono::nanoseconds duration = std::chrono::steady_clock::now() - t_start;
+	b.build_time = duration.count() / 1000.f / 1000.f;
+
+	if (p.verbose)
+		std::cout << "Sequence construction time: " << b.build_time << " ms" << std::endl;
+	export_dot(*b.sequence, name, p);
+}
+
+// set the parameters that do not change the modules and the binding on the clones of the sequence
+inline void prepare(Bench &b, const Params &p)
+{
+	b.sequence->set_n_frames(p.n_inter_frames);
+	b.sequence->set_no_copy_mode(p.no_copy_mode);
+	for (auto cur_inc : b.sequence->get_modules<module::Incrementer<>>())
+		cur_inc->set_ns(p.sleep_time_ns);
+
+	init_data(*b.sequence, b.m.initializer, p.n_inter_frames, p.data_length);
+	configure_tasks(*b.sequence, p.stats);
+}
+
+// run, check and report a benchmark, 'n_incs' is the number of increments per frame and per execution
+inline Result measure(const std::string &name, Bench &b, const Params &p, const unsigned int limit,
+                      const size_t n_incs_per_exec)
+{
+	if (p.verbose)
+		std::cout << "limit = " << limit << std::endl;
+
+	auto &sequence = *b.sequence;
+
+	Result r;
+	r.name             = name;
+	r.params           = p;
+	r.limit            = limit;
+	r.n_tasks_per_exec = count_tasks_per_exec(sequence, p.n_threads, p.stats);
+	r.elapsed_time     = run(sequence, limit, p.n_threads);
+	r.theoretical_time = ((p.sleep_time_ns * n_incs_per_exec * limit * p.n_inter_frames) / 1000.f / 1000.f) /
+	                     p.n_threads;
+	r.build_time       = b.build_time;
+	r.passed           = check(sequence, b.m.finalizer, p.n_inter_frames, (int)n_incs_per_exec);
+
+	if (p.verbose)
+	{
+		std::cout << "Sequence elapsed time: "     << r.elapsed_time     << " ms" << std::endl;
+		std::cout << "Sequence theoretical time: " << r.theoretical_time << " ms" << std::endl;
+		std::cout << "Sequence dispatch cost: " << r.get_dispatch_cost() << " ns per task ("
+		          << r.n_tasks_per_exec << " tasks per execution)" << std::endl;
+		std::cout << (r.passed ? "Tests passed!" : "Tests failed :-(") << std::endl;
+
+		// display the statistics of the tasks (if enabled)
+		tools::Stats::show(sequence.get_modules_per_types(), true);
+	}
+
+	return r;
+}
+
+// Micro-benchmark 1: Simple chain
+inline void build_chain(Bench &b, const Params &p)
+{
+	auto &m    = b.m;
+	auto &incs = m.incs;
+
+	// sockets binding
+	(*incs[0])[module::inc::sck::increment::in] = m.initializer[module::ini::sck::initialize::out];
+	for (size_t s = 0; s < incs.size() -1; s++)
+		(*incs[s+1])[module::inc::sck::increment::in] = (*incs[s])[module::inc::sck::increment::out];
+	m.finalizer[module::fin::sck::finalize::in] = (*incs[incs.size()-1])[module::inc::sck::increment::out];
+
+	build(b, "sequence_chain", p);
+}
+
+inline void chain(Bench &b, const Params &p, std::vector<Result> &results)
+{
+	const unsigned int limit = p.n_exec * p.n_threads;
+
+	prepare(b, p);
+	results.push_back(measure("chain", b, p, limit, b.m.incs.size()));
+}
+
+// Micro-benchmark 2: For loop (or while loop)
+inline void build_for_loop(Bench &b, const Params &p)
+{
+	auto &incs        = b.m.incs;
+	auto &initializer = b.m.initializer;
+	auto &finalizer   = b.m.finalizer;
+	auto &switcher    = b.m.switcher;
+	auto &iterator    = b.m.iterator;
+
+	iterator.set_limit(10);
+
+	switcher  [module::swi::tsk::select ][1]    = initializer[module::ini::sck::initialize::out];
+	iterator  [module::ite::tsk::iterate]       = switcher   [module::swi::tsk::select][3];
+	switcher  [module::swi::tsk::commute][0]    = switcher   [module::swi::tsk::select][2];
+	switcher  [module::swi::tsk::commute][1]    = iterator   [module::ite::sck::iterate::out];
+	(*incs[0])[module::inc::sck::increment::in] = switcher   [module::swi::tsk::commute][2];
+	for (size_t s = 0; s < incs.size() -1; s++)
+		(*incs[s+1])[module::inc::sck::increment::in] = (*incs[s])[module::inc::sck::increment::out];
+	switcher  [module::swi::tsk::select][0]     = (*incs[incs.size()-1])[module::inc::sck::increment::out];
+	finalizer [module::fin::sck::finalize::in]  = switcher   [module::swi::tsk::commute][3];
+
+	build(b, "sequence_for_loop", p);
+}
+
+inline void for_loop(Bench &b, const Params &p, std::vector<Result> &results)
+{
+	const auto &iterator = b.m.iterator;
+	if (p.verbose)
+		std::cout << "iterator.get_limit() = " << iterator.get_limit() << std::endl;
+	const unsigned int limit = (p.n_exec * p.n_threads) / iterator.get_limit();
+
+	prepare(b, p);
+	results.push_back(measure("for_loop", b, p, limit, b.m.incs.size() * iterator.get_limit()));
+}
+
+// Micro-benchmark 3: Do while loop
+inline void build_do_while_loop(Bench &b, const Params &p)
+{
+	auto &incs        = b.m.incs;
+	auto &initializer = b.m.initializer;
+	auto &finalizer   = b.m.finalizer;
+	auto &switcher    = b.m.switcher;
+	auto &iterator    = b.m.iterator;
+
+	// the body is executed once before the first iteration
+	iterator.set_limit(9);
+
+	switcher  [module::swi::tsk::select ][1]    = initializer[module::ini::sck::initialize::out];
+	iterator  [module::ite::tsk::iterate]       = switcher   [module::swi::tsk::select][3];
+	switcher  [module::swi::tsk::commute][1]    = iterator   [module::ite::sck::iterate::out];
+	(*incs[0])[module::inc::sck::increment::in] = switcher   [module::swi::tsk::select][2];
+	for (size_t s = 0; s < incs.size() -1; s++)
+		(*incs[s+1])[module::inc::sck::increment::in] = (*incs[s])[module::inc::sck::increment::out];
+	switcher  [module::swi::tsk::commute][0]    = (*incs[5]) [module::inc::sck::increment::out];
+	switcher  [module::swi::tsk::select ][0]    = switcher   [module::swi::tsk::commute][2];
+	finalizer [module::fin::sck::finalize::in]  = switcher   [module::swi::tsk::commute][3];
+
+	build(b, "sequence_do_while_loop", p);
+}
+
+inline void do_while_loop(Bench &b, const Params &p, std::vector<Result> &results)
+{
+	const auto &iterator = b.m.iterator;
+	if (p.verbose)
+		std::cout << "iterator.get_limit() = " << iterator.get_limit() << std::endl;
+	const unsigned int limit = (p.n_exec * p.n_threads) / (iterator.get_limit() +1);
+
+	prepare(b, p);
+	results.push_back(measure("do_while_loop", b, p, limit, b.m.incs.size() * (iterator.get_limit() +1)));
+}
+
+// Micro-benchmark 4: Exclusive paths (one result per path)
+inline void build_exclusive_paths(Bench &b, const Params &p)
+{
+	auto &incs        = b.m.incs;
+	auto &initializer = b.m.initializer;
+	auto &finalizer   = b.m.finalizer;
+	auto &switchex    = b.m.switchex;
+	auto &controller  = b.m.controller;
+
+	controller[module::ctr::tsk::control      ] = initializer[module::ini::sck::initialize::out];
+	switchex  [module::swi::tsk::commute   ][0] = initializer[module::ini::sck::initialize::out];
+	switchex  [module::swi::tsk::commute   ][1] = controller [module::ctr::sck::control   ::out];
+	// path 0
+	(*incs[0])[module::inc::sck::increment::in] = switchex   [module::swi::tsk::commute     ][2];
+	(*incs[1])[module::inc::sck::increment::in] = (*incs[0]) [module::inc::sck::increment ::out];
+	(*incs[2])[module::inc::sck::increment::in] = (*incs[1]) [module::inc::sck::increment ::out];
+	switchex  [module::swi::tsk::select    ][0] = (*incs[2]) [module::inc::sck::increment ::out];
+	// path 1
+	(*incs[3])[module::inc::sck::increment::in] = switchex   [module::swi::tsk::commute     ][3];
+	(*incs[4])[module::inc::sck::increment::in] = (*incs[3]) [module::inc::sck::increment ::out];
+	switchex  [module::swi::tsk::select    ][1] = (*incs[4]) [module::inc::sck::increment ::out];
+	// path 2
+	(*incs[5])[module::inc::sck::increment::in] = switchex   [module::swi::tsk::commute     ][4];
+	switchex  [module::swi::tsk::select    ][2] = (*incs[5]) [module::inc::sck::increment ::out];
+	// end
+	finalizer [module::fin::sck::finalize ::in] = switchex   [module::swi::tsk::select      ][3];
+
+	build(b, "sequence_exclusive_paths", p);
+}
+
+inline void exclusive_paths(Bench &b, const Params &p, std::vector<Result> &results)
+{
+	const size_t multiplier[3] = {2, 3, 6};
+	for (size_t path = 0; path < 3; path++)
+	{
+		if (p.verbose)
+			std::cout << "Sub-test " << (path+1) << " - path = " << path << " ---------------------" << std::endl;
+		const unsigned int limit = p.n_exec * p.n_threads * multiplier[path];
+
+		prepare(b, p);
+		for (auto cur_controller : b.sequence->get_cloned_modules<module::Controller>(b.m.controller))
+			cur_controller->set_path(path);
+
+		results.push_back(measure("exclusive_paths_" + std::to_string(path), b, p, limit,
+		                          b.m.incs.size() / multiplier[path]));
+	}
+}
+
+// Micro-benchmark 5: Nested loops
+inline void build_nested_loops(Bench &b, const Params &p)
+{
+	auto &incs        = b.m.incs;
+	auto &initializer = b.m.initializer;
+	auto &finalizer   = b.m.finalizer;
+	auto &switcher    = b.m.switcher;
+	auto &switcher2   = b.m.switcher2;
+	auto &iterator    = b.m.iterator;
+	auto &iterator2   = b.m.iterator2;
+
+	iterator .set_limit(5);
+	iterator2.set_limit(2);
+
+	switcher2 [module::swi::tsk::select ][1]    = initializer[module::ini::sck::initialize::out];
+	iterator2 [module::ite::tsk::iterate]       = switcher2  [module::swi::tsk::select][3];
+	switcher2 [module::swi::tsk::commute][0]    = switcher2  [module::swi::tsk::select][2];
+	switcher2 [module::swi::tsk::commute][1]    = iterator2  [module::ite::sck::iterate::out];
+	switcher  [module::swi::tsk::select ][1]    = switcher2  [module::swi::tsk::commute][2];
+	iterator  [module::ite::tsk::iterate]       = switcher   [module::swi::tsk::select ][3];
+	switcher  [module::swi::tsk::commute][0]    = switcher   [module::swi::tsk::select ][2];
+	switcher  [module::swi::tsk::commute][1]    = iterator   [module::ite::sck::iterate::out];
+	(*incs[0])[module::inc::sck::increment::in] = switcher   [module::swi::tsk::commute][2];
+	for (size_t s = 0; s < incs.size() -1; s++)
+		(*incs[s+1])[module::inc::sck::increment::in] = (*incs[s])[module::inc::sck::increment::out];
+	switcher  [module::swi::tsk::select][0]     = (*incs[incs.size()-1])[module::inc::sck::increment::out];
+	switcher2 [module::swi::tsk::select][0]     = switcher   [module::swi::tsk::commute][3];
+	finalizer [module::fin::sck::finalize::in]  = switcher2  [module::swi::tsk::commute][3];
+
+	build(b, "sequence_nested_loops", p);
+}
+
+inline void nested_loops(Bench &b, const Params &p, std::vector<Result> &results)
+{
+	const auto &iterator  = b.m.iterator;
+	const auto &iterator2 = b.m.iterator2;
+	if (p.verbose)
+	{
+		std::cout << "iterator.get_limit() = "  << iterator .get_limit() << std::endl;
+		std::cout << "iterator2.get_limit() = " << iterator2.get_limit() << std::endl;
+	}
+	const unsigned int limit = (p.n_exec * p.n_threads) / (iterator.get_limit() * iterator2.get_limit());
+
+	prepare(b, p);
+	results.push_back(measure("nested_loops", b, p, limit,
+	                          b.m.incs.size() * iterator.get_limit() * iterator2.get_limit()));
+}
+
+// the 5 micro-benchmarks, their sequences are built once for 'n_threads' and 'data_length' and then reused by 'run'
+class Suite
+{
+protected:
+	const size_t n_threads;
+	const size_t data_length;
+	Bench        b_chain, b_for_loop, b_do_while_loop, b_exclusive_paths, b_nested_loops;
+
+public:
+	explicit Suite(const Params &p)
+	: n_threads(p.n_threads), data_length(p.data_length),
+	  b_chain(p), b_for_loop(p), b_do_while_loop(p), b_exclusive_paths(p), b_nested_loops(p)
+	{
+		build_chain          (this->b_chain,           p);
+		build_for_loop       (this->b_for_loop,        p);
+		build_do_while_loop  (this->b_do_while_loop,   p);
+		build_exclusive_paths(this->b_exclusive_paths, p);
+		build_nested_loops   (this->b_nested_loops,    p);
+	}
+
+	// total construction time of the 5 sequences (in ms)
+	float get_build_time() const
+	{
+		return this->b_chain.build_time + this->b_for_loop.build_time + this->b_do_while_loop.build_time +
+		       this->b_exclusive_paths.build_time + this->b_nested_loops.build_time;
+	}
+
+	// 'p.n_threads' and 'p.data_length' have to be the ones of the construction
+	std::vector<Result> run(const Params &p)
+	{
+		if (p.n_threads != this->n_threads || p.data_length != this->data_length)
+			throw tools::invalid_argument(__FILE__, __LINE__, __func__, "The sequences have been built for other "
+			                                                           "'n_threads' or 'data_length' values.");
+
+		std::vector<Result> results;
+
+		print_title("Micro-benchmark 1: Simple chain");
+		chain(this->b_chain, p, results);
+		std::cout << std::endl;
+
+		print_title("Micro-benchmark 2: For loop (or while loop)");
+		for_loop(this->b_for_loop, p, results);
+		std::cout << std::endl;
+
+		print_title("Micro-benchmark 3: Do while loop");
+		do_while_loop(this->b_do_while_loop, p, results);
+		std::cout << std::endl;
+
+		print_title("Micro-benchmark 4: Exclusive paths");
+		exclusive_paths(this->b_exclusive_paths, p, results);
+		std::cout << std::endl;
+
+		print_title("Micro-benchmark 5: Nested loops");
+		nested_loops(this->b_nested_loops, p, results);
+
+		return results;
+	}
+};
+
+// run the 5 micro-benchmarks with the same parameters
+inline std::vector<Result> run_all(const Params &p)
+{
+	Suite suite(p);
+	return suite.run(p);
+}
+}
+
+#endif /* BENCHMARKS_HPP_ */
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <thread>
+
+#include <aff3ct.hpp>
+using namespace aff3ct;
+
+#include "Benchmarks.hpp"
+
+// the micro-benchmarks are run for each combination of these parameters
+struct grid
+{
+	std::vector<size_t> n_threads      = { 1, std::thread::hardware_concurrency() };
+	std::vector<size_t> n_inter_frames = { 1, 8 };
+	std::vector<size_t> data_length    = { 2048 };
+	std::vector<bool>   no_copy_mode   = { true, false };
+	std::vector<size_t> sleep_time_ns  = { 5000, 0 };                // 0 = measure the dispatch cost of the tasks
+	size_t              n_exec         = 20000;                      // number of executions per thread
+	float               tolerance      = 0.25f;                      // maximum relative drift from the theoretical time
+	float               max_dispatch   = 5000.f;                     // maximum dispatch cost (in ns) without sleep time
+	std::string         json_path      = "sequence_tests.json";      // results (comparable with a previous run)
+};
+
+// unique name of a result, the same from one run to another
+std::string get_id(const bench::Result &r)
+{
+	return r.name + "/t" + std::to_string(r.params.n_threads)      +
+	                "/f" + std::to_string(r.params.n_inter_frames) +
+	                "/d" + std::to_string(r.params.data_length)    +
+	                "/s" + std::to_string(r.params.sleep_time_ns)  +
+	                (r.params.no_copy_mode ? "/no_copy" : "/copy");
+}
+
+// with 'sleep_time_ns' = 0 the drift is 0 by definition, the dispatch cost is checked instead
+std::string get_status(const bench::Result &r, const grid &g)
+{
+	if (!r.passed)
+		return "WRONG DATA";
+	if (std::abs(r.get_drift()) > g.tolerance)
+		return "DRIFT";
+	if (r.params.sleep_time_ns == 0 && r.get_dispatch_cost() > g.max_dispatch)
+		return "DISPATCH";
+	return "OK";
+}
+
+void write_json(std::ostream &os, const std::vector<bench::Result> &results, const grid &g)
+{
+	os << std::setprecision(9); // exact single precision values
+	os << "{" << std::endl;
+	os << "  \"tolerance\": " << g.tolerance << "," << std::endl;
+	os << "  \"max_dispatch_cost_ns\": " << g.max_dispatch << "," << std::endl;
+	os << "  \"benchmarks\": [";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const auto &r = results[i];
+		os << (i ? "," : "") << std::endl
+		   << "    { \"id\": \""             << get_id(r)                             << "\""
+		   << ", \"name\": \""               << r.name                                << "\""
+		   << ", \"n_threads\": "            << r.params.n_threads
+		   << ", \"n_inter_frames\": "       << r.params.n_inter_frames
+		   << ", \"data_length\": "          << r.params.data_length
+		   << ", \"no_copy_mode\": "         << (r.params.no_copy_mode ? "true" : "false")
+		   << ", \"sleep_time_ns\": "        << r.params.sleep_time_ns
+		   << ", \"limit\": "                << r.limit
+		   << ", \"elapsed_time_ms\": "      << r.elapsed_time
+		   << ", \"theoretical_time_ms\": "  << r.theoretical_time
+		   << ", \"drift\": "                << r.get_drift()
+		   << ", \"n_tasks_per_exec\": "     << r.n_tasks_per_exec
+		   << ", \"dispatch_cost_ns\": "     << r.get_dispatch_cost()
+		   << ", \"build_time_ms\": "        << r.build_time
+		   << ", \"passed\": "               << (r.passed ? "true" : "false")
+		   << ", \"status\": \""             << get_status(r, g)                      << "\""
+		   << " }";
+	}
+	os << std::endl << "  ]" << std::endl << "}" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	grid g;
+	if (argc > 1)
+		g.json_path = argv[1];
+	if (argc > 2)
+		g.tolerance = std::atof(argv[2]);
+	if (argc > 3)
+		g.max_dispatch = std::atof(argv[3]);
+
+	std::vector<bench::Result> results;
+	for (auto n_threads : g.n_threads)
+		for (auto data_length : g.data_length)
+		{
+			bench::Params p;
+			p.n_threads   = n_threads;
+			p.data_length = data_length;
+			p.n_exec      = g.n_exec;
+			p.stats       = false;
+			p.verbose     = false;
+			p.export_dot  = false;
+
+			// the sequences depend only on the number of threads and on the data length: they are built once
+			bench::Suite suite(p);
+			std::cout << "# n_threads = " << n_threads << ", data_length = " << data_length
+			          << ": sequences built in " << suite.get_build_time() << " ms" << std::endl;
+
+			for (auto n_inter_frames : g.n_inter_frames)
+				for (auto no_copy_mode : g.no_copy_mode)
+					for (auto sleep_time_ns : g.sleep_time_ns)
+					{
+						p.n_inter_frames = n_inter_frames;
+						p.no_copy_mode   = no_copy_mode;
+						p.sleep_time_ns  = sleep_time_ns;
+
+						std::cout << "# n_threads = " << n_threads << ", n_inter_frames = " << n_inter_frames
+						          << ", data_length = " << data_length << ", no_copy_mode = " << no_copy_mode
+						          << ", sleep_time_ns = " << sleep_time_ns << std::endl;
+						for (auto &r : suite.run(p))
+							results.push_back(r);
+						std::cout << std::endl;
+					}
+		}
+
+	// display the results and check the drifts from the theoretical times (and the dispatch costs)
+	unsigned int n_failed = 0;
+	std::cout << "# " << std::setw(40) << std::left << "Benchmark" << std::right
+	          << " | " << std::setw(12) << "Elapsed (ms)" << " | " << std::setw(12) << "Theo. (ms)"
+	          << " | " << std::setw(8) << "Drift" << " | " << std::setw(14) << "Dispatch (ns)" << " | Status" << std::endl;
+	for (auto &r : results)
+	{
+		const auto status = get_status(r, g);
+		n_failed += status != "OK";
+		std::cout << "# " << std::setw(40) << std::left << get_id(r) << std::right
+		          << " | " << std::setw(12) << std::fixed << std::setprecision(2) << r.elapsed_time
+		          << " | " << std::setw(12) << r.theoretical_time
+		          << " | " << std::setw(7) << std::setprecision(1) << r.get_drift() * 100.f << "%"
+		          << " | " << std::setw(14) << r.get_dispatch_cost()
+		          << " | " << status << std::endl;
+	}
+
+	std::ofstream file(g.json_path);
+	write_json(file, results, g);
+	std::cout << "# Results written in '" << g.json_path << "'" << std::endl;
+	std::cout << "# " << (results.size() - n_failed) << "/" << results.size() << " benchmarks passed" << std::endl;
+
+	return n_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -13,9 +13,12 @@
 #include <aff3ct.hpp>
 using namespace aff3ct;
 
+#include "Thread_placement.hpp"
+
 struct params
 {
 	size_t n_threads = std::thread::hardware_concurrency();
+	std::string thread_placement = "NONE"; // threads pinning: "NONE", "COMPACT", "SCATTER" or a list of PUIDs "0,2,..."
 	float  ebn0_min  =  0.00f; // minimum SNR value
 	float  ebn0_max  = 10.01f; // maximum SNR value
 	float  ebn0_step =  1.00f; // SNR step
@@ -194,8 +197,11 @@ void init_modules(const params &p, modules &m)
 
 void init_utils(const params &p, const modules &m, utils &u)
 {
+	// the threads are pinned before cloning the modules (first-touch allocation on their NUMA node)
+	const size_t n_threads = p.n_threads ? p.n_threads : 1;
+	const tools::Thread_placement placement(p.thread_placement);
 	u.sequence = std::unique_ptr<tools::Sequence>(new tools::Sequence((*m.source)[module::src::tsk::generate],
-		p.n_threads ? p.n_threads : 1));
+		n_threads, placement.is_pinning(), placement.get_puids(n_threads)));
 	// allocate a common monitor module to reduce all the monitors
 	u.monitor_red = std::unique_ptr<tools::Monitor_BFER_reduction>(new tools::Monitor_BFER_reduction(
 		u.sequence->get_modules<module::Monitor_BFER<>>()));
@@ -7,21 +7,28 @@
 #include <aff3ct.hpp>
 using namespace aff3ct;
 
+#include "Perf_counters.hpp"
+#include "Socket_arena.hpp"
+
 struct params
 {
-	int   K         =  32;     // number of information bits
-	int   N         = 128;     // codeword size
-	int   fe        = 100;     // number of frame errors
-	int   seed      =   0;     // PRNG seed for the AWGN channel
-	float ebn0_min  =   0.00f; // minimum SNR value
-	float ebn0_max  =  10.01f; // maximum SNR value
-	float ebn0_step =   1.00f; // SNR step
-	float R;                   // code rate (R=K/N)
+	int   K            =  32;     // number of information bits
+	int   N            = 128;     // codeword size
+	int   fe           = 100;     // number of frame errors
+	int   n_frames     =   8;     // number of frames processed per task execution (inter frame batching)
+	int   seed         =   0;     // PRNG seed for the AWGN channel
+	float ebn0_min     =   0.00f; // minimum SNR value
+	float ebn0_max     =  10.01f; // maximum SNR value
+	float ebn0_step    =   1.00f; // SNR step
+	bool  hw_counters  = false;   // collect the hardware performance counters of the tasks (Linux only)
+	bool  socket_arena = false;   // allocate the output sockets of the chain in one block (instead of autoalloc)
+	float R;                      // code rate (R=K/N)
 };
 void init_params(params &p);
 
 struct modules
 {
+	std::unique_ptr<tools::Socket_arena>              arena; // output sockets of the chain (if enabled), outlives the tasks
 	std::unique_ptr<module::Source_random<>>          source;
 	std::unique_ptr<module::Encoder_repetition_sys<>> encoder;
 	std::unique_ptr<module::Modem_BPSK<>>             modem;
@@ -37,8 +44,9 @@ struct utils
 	std::unique_ptr<tools::Sigma<>>               noise;     // a sigma noise type
 	std::vector<std::unique_ptr<tools::Reporter>> reporters; // list of reporters dispayed in the terminal
 	std::unique_ptr<tools::Terminal_std>          terminal;  // manage the output text in the terminal
+	std::unique_ptr<tools::Perf_counters>         counters;  // hardware performance counters of the tasks
 };
-void init_utils(const modules &m, utils &u);
+void init_utils(const params &p, const modules &m, utils &u);
 
 int main(int argc, char** argv)
 {
@@ -55,7 +63,7 @@ int main(int argc, char** argv)
 
 	params  p; init_params (p   ); // create and initialize the parameters defined by the user
 	modules m; init_modules(p, m); // create and initialize the modules
-	utils   u; init_utils  (m, u); // create and initialize the utils
+	utils   u; init_utils  (p, m, u); // create and initialize the utils
 
 	// display the legend in the terminal
 	u.terminal->legend();
@@ -71,7 +79,7 @@ int main(int argc, char** argv)
 	(*m.monitor)[mnt::sck::check_errors::U    ].bind((*m.encoder)[enc::sck::encode     ::U_K ]);
 	(*m.monitor)[mnt::sck::check_errors::V    ].bind((*m.decoder)[dec::sck::decode_siho::V_K ]);
 
-	std::vector<float> sigma(1);
+	std::vector<float> sigma(p.n_frames); // one noise value per frame
 	(*m.channel)[chn::sck::add_noise ::CP].bind(sigma);
 	(*m.modem  )[mdm::sck::demodulate::CP].bind(sigma);
 
@@ -90,13 +98,13 @@ int main(int argc, char** argv)
 		// run the simulation chain
 		while (!m.monitor->fe_limit_achieved() && !u.terminal->is_interrupt())
 		{
-			(*m.source )[src::tsk::generate    ].exec();
-			(*m.encoder)[enc::tsk::encode      ].exec();
-			(*m.modem  )[mdm::tsk::modulate    ].exec();
-			(*m.channel)[chn::tsk::add_noise   ].exec();
-			(*m.modem  )[mdm::tsk::demodulate  ].exec();
-			(*m.decoder)[dec::tsk::decode_siho ].exec();
-			(*m.monitor)[mnt::tsk::check_errors].exec();
+			u.counters->exec((*m.source )[src::tsk::generate    ]);
+			u.counters->exec((*m.encoder)[enc::tsk::encode      ]);
+			u.counters->exec((*m.modem  )[mdm::tsk::modulate    ]);
+			u.counters->exec((*m.channel)[chn::tsk::add_noise   ]);
+			u.counters->exec((*m.modem  )[mdm::tsk::demodulate  ]);
+			u.counters->exec((*m.decoder)[dec::tsk::decode_siho ]);
+			u.counters->exec((*m.monitor)[mnt::tsk::check_errors]);
 		}
 
 		// display the performance (BER and FER) in the terminal
@@ -113,6 +121,7 @@ int main(int argc, char** argv)
 	// display the statistics of the tasks (if enabled)
 	std::cout << "#" << std::endl;
 	tools::Stats::show(m.list, true);
+	u.counters->show(); // display the hardware counters of the tasks (if enabled)
 	std::cout << "# End of the simulation" << std::endl;
 
 	return 0;
@@ -123,6 +132,7 @@ void init_params(params &p)
 	p.R = (float)p.K / (float)p.N;
 	std::cout << "# * Simulation parameters: "              << std::endl;
 	std::cout << "#    ** Frame errors   = " << p.fe        << std::endl;
+	std::cout << "#    ** Inter frames   = " << p.n_frames  << std::endl;
 	std::cout << "#    ** Noise seed     = " << p.seed      << std::endl;
 	std::cout << "#    ** Info. bits (K) = " << p.K         << std::endl;
 	std::cout << "#    ** Frame size (N) = " << p.N         << std::endl;
@@ -145,11 +155,19 @@ void init_modules(const params &p, modules &m)
 
 	m.list = { m.source.get(), m.encoder.get(), m.modem.get(), m.channel.get(), m.decoder.get(), m.monitor.get() };
 
+	// each task execution processes 'n_frames' frames (the monitor counts the errors per frame)
+	m.source ->set_n_frames(p.n_frames);
+	m.encoder->set_n_frames(p.n_frames);
+	m.modem  ->set_n_frames(p.n_frames);
+	m.channel->set_n_frames(p.n_frames);
+	m.decoder->set_n_frames(p.n_frames);
+	m.monitor->set_n_frames(p.n_frames);
+
 	// configuration of the module tasks
 	for (auto& mod : m.list)
 		for (auto& tsk : mod->tasks)
 		{
-			tsk->set_autoalloc  (true ); // enable the automatic allocation of the data in the tasks
+			tsk->set_autoalloc  (!p.socket_arena); // enable the automatic allocation of the data in the tasks
 			tsk->set_debug      (false); // disable the debug mode
 			tsk->set_debug_limit(16   ); // display only the 16 first bits if the debug mode is enabled
 			tsk->set_stats      (true ); // enable the statistics
@@ -158,9 +176,24 @@ void init_modules(const params &p, modules &m)
 			if (!tsk->is_debug() && !tsk->is_stats())
 				tsk->set_fast(true);
 		}
+
+	// the output sockets of the chain in one 64-byte aligned block, in the execution order of the tasks
+	if (p.socket_arena)
+	{
+		using namespace module;
+		m.arena = std::unique_ptr<tools::Socket_arena>(new tools::Socket_arena({&(*m.source )[src::tsk::generate    ],
+		                                                                        &(*m.encoder)[enc::tsk::encode      ],
+		                                                                        &(*m.modem  )[mdm::tsk::modulate    ],
+		                                                                        &(*m.channel)[chn::tsk::add_noise   ],
+		                                                                        &(*m.modem  )[mdm::tsk::demodulate  ],
+		                                                                        &(*m.decoder)[dec::tsk::decode_siho ],
+		                                                                        &(*m.monitor)[mnt::tsk::check_errors]}));
+		std::cout << "# Socket arena: " << m.arena->get_n_sockets() << " sockets, " << m.arena->get_n_bytes()
+		          << " bytes" << std::endl;
+	}
 }
 
-void init_utils(const modules &m, utils &u)
+void init_utils(const params &p, const modules &m, utils &u)
 {
 	// create a sigma noise type
 	u.noise = std::unique_ptr<tools::Sigma<>>(new tools::Sigma<>());
@@ -172,4 +205,6 @@ void init_utils(const modules &m, utils &u)
 	u.reporters.push_back(std::unique_ptr<tools::Reporter>(new tools::Reporter_throughput<>(*m.monitor)));
 	// create a terminal that will display the collected data from the reporters
 	u.terminal = std::unique_ptr<tools::Terminal_std>(new tools::Terminal_std(u.reporters));
+	// open the hardware performance counters of the calling thread (if enabled)
+	u.counters = std::unique_ptr<tools::Perf_counters>(new tools::Perf_counters(p.hw_counters));
 }
@@ -0,0 +1,287 @@
+#ifndef DECODER_RSC_BCJR_INTER_GENERIC_HPP_
+#define DECODER_RSC_BCJR_INTER_GENERIC_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <string>
+
+#include <mipp.h>
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace module
+{
+/*
+ * Max-log BCJR decoder for any RSC trellis (from 'Encoder_RSC_sys::get_trellis()'),
+ * inter-frame SIMD: 'mipp::N<float>()' frames are decoded in lockstep, one per
+ * vector lane. The frames are processed by groups of 'get_n_frames_per_call()',
+ * use 'set_n_frames()' (or 'Sequence::set_n_frames()') with a multiple of it, the
+ * lanes of an incomplete group are padded with zeros.
+ *
+ * Same sockets as 'Decoder_RSC_BCJR' (buffered encoding):
+ *   - decode_siso: Y_N1 = [sys + tail sys | par + tail par] LLRs, Y_N2 = the
+ *                  extrinsic LLRs of all these bits (same layout),
+ *   - decode_siho: Y_N  = the same LLRs as Y_N1, V_K = the decoded bits.
+ */
+template <typename B = int>
+class Decoder_RSC_BCJR_inter_generic : public Module
+{
+	using R = float;
+
+public:
+	inline Task& operator[](const dec::tsk t)
+	{
+		return Module::operator[](t == dec::tsk::decode_siso ? 0 : 1);
+	}
+
+	inline Socket& operator[](const dec::sck::decode_siso s)
+	{
+		auto &t = Module::operator[](0);
+		switch (s)
+		{
+			case dec::sck::decode_siso::Y_N1: return t[0];
+			case dec::sck::decode_siso::Y_N2: return t[1];
+			default:                          return t[2]; // status
+		}
+	}
+
+	inline Socket& operator[](const dec::sck::decode_siho s)
+	{
+		auto &t = Module::operator[](1);
+		switch (s)
+		{
+			case dec::sck::decode_siho::Y_N: return t[0];
+			case dec::sck::decode_siho::V_K: return t[1];
+			default:                         return t[2]; // status
+		}
+	}
+
+protected:
+	const int K;        // number of information bits
+	const int n_states; // number of states of the trellis
+	const int L;        // number of trellis sections (K + tail bits)
+	const int N;        // 2 * L (systematic and parity LLRs)
+	const int W;        // number of SIMD lanes (= frames decoded in lockstep)
+
+	// transitions for u = 0 (trellis[6] and [7], +gamma) and u = 1 (trellis[8] and [9], -gamma): next state and gamma
+	// index (gamma0 = (sys+par)/2, gamma1 = (sys-par)/2)
+	std::vector<int> next0, next1, gidx0, gidx1;
+
+	// all the buffers are in the inter-frame layout: [section][state][lane]
+	mipp::vector<R> sys, par;       // L * W
+	mipp::vector<R> alpha;          // (L+1) * n_states * W
+	mipp::vector<R> beta0, beta1;   // n_states * W
+	mipp::vector<R> post_sys;       // L * W
+	mipp::vector<R> post_par;       // L * W
+
+public:
+	Decoder_RSC_BCJR_inter_generic(const int K, const std::vector<std::vector<int>> &trellis)
+	: Module(),
+	  K(K),
+	  n_states(trellis.size() >= 10 ? (int)trellis[6].size() : 0),
+	  L(K + Decoder_RSC_BCJR_inter_generic<B>::n_memories(n_states)),
+	  N(2 * L),
+	  W(mipp::N<R>()),
+	  next0(n_states), next1(n_states), gidx0(n_states), gidx1(n_states),
+	  sys((size_t)L * W), par((size_t)L * W),
+	  alpha((size_t)(L +1) * n_states * W),
+	  beta0((size_t)n_states * W), beta1((size_t)n_states * W),
+	  post_sys((size_t)L * W), post_par((size_t)L * W)
+	{
+		const std::string name = "Decoder_RSC_BCJR_inter_generic";
+		this->set_name(name);
+		this->set_short_name(name);
+		this->set_single_wave(true);
+
+		if (K <= 0)
+			throw tools::invalid_argument(__FILE__, __LINE__, __func__, "'K' has to be greater than 0.");
+		if (trellis.size() < 10 || n_states < 2 || (n_states & (n_states -1)))
+			throw tools::invalid_argument(__FILE__, __LINE__, __func__, "'trellis' is not a valid RSC trellis.");
+
+		for (auto s = 0; s < n_states; s++)
+		{
+			this->next0[s] = trellis[6][s]; this->gidx0[s] = trellis[7][s];
+			this->next1[s] = trellis[8][s]; this->gidx1[s] = trellis[9][s];
+		}
+
+		auto &p1 = this->create_task("decode_siso");
+		auto p1s_Y_N1 = this->template create_socket_in <R>(p1, "Y_N1", this->N);
+		auto p1s_Y_N2 = this->template create_socket_out<R>(p1, "Y_N2", this->N);
+		this->create_codelet(p1, [p1s_Y_N1, p1s_Y_N2](Module &m, Task &t, const size_t) -> int
+		{
+			auto &dec = static_cast<Decoder_RSC_BCJR_inter_generic<B>&>(m);
+			dec.decode_siso(static_cast<const R*>(t[p1s_Y_N1].get_dataptr()),
+			                static_cast<      R*>(t[p1s_Y_N2].get_dataptr()));
+			return status_t::SUCCESS;
+		});
+
+		auto &p2 = this->create_task("decode_siho");
+		auto p2s_Y_N = this->template create_socket_in <R>(p2, "Y_N", this->N);
+		auto p2s_V_K = this->template create_socket_out<B>(p2, "V_K", this->K);
+		this->create_codelet(p2, [p2s_Y_N, p2s_V_K](Module &m, Task &t, const size_t) -> int
+		{
+			auto &dec = static_cast<Decoder_RSC_BCJR_inter_generic<B>&>(m);
+			dec.decode_siho(static_cast<const R*>(t[p2s_Y_N].get_dataptr()),
+			                static_cast<      B*>(t[p2s_V_K].get_dataptr()));
+			return status_t::SUCCESS;
+		});
+	}
+
+	virtual ~Decoder_RSC_BCJR_inter_generic() = default;
+
+	virtual Decoder_RSC_BCJR_inter_generic<B>* clone() const
+	{
+		auto m = new Decoder_RSC_BCJR_inter_generic<B>(*this);
+		m->deep_copy(*this);
+		return m;
+	}
+
+	int get_n_frames_per_call() const { return this->W; }
+
+	// decode all the frames of the task
+	void decode_siso(const R *Y_N1, R *Y_N2)
+	{
+		for (size_t f = 0; f < this->get_n_frames(); f += this->W)
+		{
+			const auto n_cur = std::min((size_t)this->W, this->get_n_frames() - f);
+			this->load  (Y_N1 + f * this->N, n_cur);
+			this->decode();
+			for (size_t l = 0; l < n_cur; l++)
+			{
+				R *ext = Y_N2 + (f + l) * this->N;
+				for (auto i = 0; i < this->L; i++)
+				{
+					ext[         i] = this->post_sys[i * this->W + l] - this->sys[i * this->W + l];
+					ext[this->L +i] = this->post_par[i * this->W + l] - this->par[i * this->W + l];
+				}
+			}
+		}
+	}
+
+	void decode_siho(const R *Y_N, B *V_K)
+	{
+		for (size_t f = 0; f < this->get_n_frames(); f += this->W)
+		{
+			const auto n_cur = std::min((size_t)this->W, this->get_n_frames() - f);
+			this->load  (Y_N + f * this->N, n_cur);
+			this->decode();
+			for (size_t l = 0; l < n_cur; l++)
+			{
+				B *dec = V_K + (f + l) * this->K;
+				for (auto i = 0; i < this->K; i++)
+					dec[i] = this->post_sys[i * this->W + l] < 0 ? (B)1 : (B)0;
+			}
+		}
+	}
+
+protected:
+	// number of memories of the encoder (= number of tail bits)
+	static int n_memories(const int n_states)
+	{
+		auto m = 0;
+		while ((1 << m) < n_states) m++;
+		return m;
+	}
+
+	// transpose 'n_cur' frames in the inter-frame layout
+	void load(const R *Y_N, const size_t n_cur)
+	{
+		for (size_t l = 0; l < (size_t)this->W; l++)
+			for (auto i = 0; i < this->L; i++)
+			{
+				this->sys[i * this->W + l] = l < n_cur ? Y_N[l * this->N +           i] : (R)0;
+				this->par[i * this->W + l] = l < n_cur ? Y_N[l * this->N + this->L + i] : (R)0;
+			}
+	}
+
+	// max-log forward/backward recursions on the W lanes, computes 'post_sys' and 'post_par'
+	void decode()
+	{
+		const auto S = this->n_states;
+		const auto W = this->W;
+		const mipp::Reg<R> r_inf  = (R)-1e20;
+		const mipp::Reg<R> r_half = (R)0.5;
+
+		// forward recursion (the encoder starts in state 0)
+		for (auto s = 0; s < S; s++)
+			mipp::Reg<R>(s == 0 ? (R)0 : (R)-1e20).store(&this->alpha[s * W]);
+
+		for (auto i = 0; i < this->L; i++)
+		{
+			const mipp::Reg<R> r_sys = &this->sys[i * W];
+			const mipp::Reg<R> r_par = &this->par[i * W];
+			const mipp::Reg<R> g[2] = {(r_sys + r_par) * r_half, (r_sys - r_par) * r_half};
+
+			const R *a_cur = &this->alpha[((i +0) * S) * W];
+			      R *a_nxt = &this->alpha[((i +1) * S) * W];
+			for (auto s = 0; s < S; s++)
+				r_inf.store(a_nxt + s * W);
+
+			for (auto s = 0; s < S; s++)
+			{
+				const mipp::Reg<R> a = a_cur + s * W;
+				R *n0 = a_nxt + this->next0[s] * W;
+				R *n1 = a_nxt + this->next1[s] * W;
+				mipp::max(mipp::Reg<R>(n0), a + g[this->gidx0[s]]).store(n0);
+				mipp::max(mipp::Reg<R>(n1), a - g[this->gidx1[s]]).store(n1);
+			}
+
+			// normalization
+			const mipp::Reg<R> a0 = a_nxt;
+			for (auto s = 0; s < S; s++)
+				(mipp::Reg<R>(a_nxt + s * W) - a0).store(a_nxt + s * W);
+		}
+
+		// backward recursion (the tail bits bring the encoder back to state 0) and a posteriori LLRs
+		R *b_nxt = this->beta0.data();
+		R *b_cur = this->beta1.data();
+		for (auto s = 0; s < S; s++)
+			mipp::Reg<R>(s == 0 ? (R)0 : (R)-1e20).store(b_nxt + s * W);
+
+		for (auto i = this->L -1; i >= 0; i--)
+		{
+			const mipp::Reg<R> r_sys = &this->sys[i * W];
+			const mipp::Reg<R> r_par = &this->par[i * W];
+			const mipp::Reg<R> g[2] = {(r_sys + r_par) * r_half, (r_sys - r_par) * r_half};
+
+			const R *a_cur = &this->alpha[(i * S) * W];
+			mipp::Reg<R> max_u0 = r_inf, max_u1 = r_inf; // systematic bit = 0 / 1
+			mipp::Reg<R> max_p0 = r_inf, max_p1 = r_inf; // parity bit = 0 / 1
+
+			for (auto s = 0; s < S; s++)
+			{
+				const mipp::Reg<R> b0 = mipp::Reg<R>(b_nxt + this->next0[s] * W) + g[this->gidx0[s]];
+				const mipp::Reg<R> b1 = mipp::Reg<R>(b_nxt + this->next1[s] * W) - g[this->gidx1[s]];
+				mipp::max(b0, b1).store(b_cur + s * W);
+
+				const mipp::Reg<R> a  = a_cur + s * W;
+				const mipp::Reg<R> m0 = a + b0;
+				const mipp::Reg<R> m1 = a + b1;
+				max_u0 = mipp::max(max_u0, m0);
+				max_u1 = mipp::max(max_u1, m1);
+
+				// parity bit = gamma index ^ u
+				if (this->gidx0[s] == 0) max_p0 = mipp::max(max_p0, m0);
+				else                     max_p1 = mipp::max(max_p1, m0);
+				if (this->gidx1[s] == 1) max_p0 = mipp::max(max_p0, m1);
+				else                     max_p1 = mipp::max(max_p1, m1);
+			}
+
+			(max_u0 - max_u1).store(&this->post_sys[i * W]);
+			(max_p0 - max_p1).store(&this->post_par[i * W]);
+
+			// normalization
+			const mipp::Reg<R> b0 = b_cur;
+			for (auto s = 0; s < S; s++)
+				(mipp::Reg<R>(b_cur + s * W) - b0).store(b_cur + s * W);
+
+			std::swap(b_cur, b_nxt);
+		}
+	}
+};
+}
+}
+
+#endif /* DECODER_RSC_BCJR_INTER_GENERIC_HPP_ */
@@ -0,0 +1,183 @@
+#ifndef GAUSSIAN_NOISE_GENERATOR_PHILOX_HPP_
+#define GAUSSIAN_NOISE_GENERATOR_PHILOX_HPP_
+
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+
+#include <mipp.h>
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace tools
+{
+/*
+ * Gaussian noise generator for the channels: counter-based PRNG (Philox4x32-10)
+ * and SIMD Box-Muller transform (MIPP), the noise is generated ahead by blocks
+ * of 'pool_size' standard normal samples and 'generate' only scales them.
+ *
+ * The key of the Philox PRNG is {seed, stream}: two generators with different
+ * keys draw independent sequences. A clone keeps the key of its original, the
+ * caller gives each clone its own key with 'set_seed' (e.g. the seeds given in
+ * the thread order of a 'Sequence') and/or 'set_stream' (e.g. the thread id),
+ * so the key of a thread does not depend on the order of the cloning. The
+ * samples of a key do not depend on the sizes of the 'generate' calls: the
+ * noise is reproducible for the given seeds and streams.
+ */
+template <typename R = float>
+class Gaussian_noise_generator_philox : public Gaussian_noise_generator<R>
+{
+	static_assert(std::is_same<R,float>::value, "The Philox Gaussian noise generator is single precision only.");
+
+protected:
+	static constexpr size_t P = 8; // Philox blocks computed together (one per SIMD lane)
+
+	uint32_t        key[2];  // {seed, stream}
+	uint64_t        counter; // index of the next Philox block of the key
+	mipp::vector<R> pool;    // standard normal samples generated ahead
+	size_t          pos;     // first sample of 'pool' not used yet
+
+public:
+	explicit Gaussian_noise_generator_philox(const int seed = 0, const size_t pool_size = 1 << 16,
+	                                         const uint32_t stream = 0)
+	: Gaussian_noise_generator<R>(seed),
+	  counter(0),
+	  // a multiple of 4 * P (Philox blocks) and of 2 * mipp::N<R>() (the 2 halves of the Box-Muller transform)
+	  pool(((pool_size + 4 * P * mipp::N<R>() -1) / (4 * P * mipp::N<R>())) * (4 * P * mipp::N<R>())),
+	  pos(0)
+	{
+		if (pool_size == 0)
+			throw invalid_argument(__FILE__, __LINE__, __func__, "'pool_size' has to be greater than 0.");
+
+		this->key[0] = (uint32_t)seed;
+		this->key[1] = stream;
+		this->pos    = this->pool.size();
+	}
+
+	virtual ~Gaussian_noise_generator_philox() = default;
+
+	virtual Gaussian_noise_generator_philox<R>* clone() const
+	{
+		auto g = new Gaussian_noise_generator_philox<R>(*this);
+		g->counter = 0;
+		g->pos     = g->pool.size();
+		return g;
+	}
+
+	virtual void set_seed(const int seed)
+	{
+		this->key[0]  = (uint32_t)seed;
+		this->counter = 0;
+		this->pos     = this->pool.size();
+	}
+
+	void set_stream(const uint32_t stream)
+	{
+		this->key[1]  = stream;
+		this->counter = 0;
+		this->pos     = this->pool.size();
+	}
+
+	uint32_t get_stream() const { return this->key[1]; }
+
+	virtual void generate(R *noise, const unsigned length, const R sigma, const R mu = 0.0)
+	{
+		size_t i = 0;
+		while (i < (size_t)length)
+		{
+			if (this->pos == this->pool.size())
+				this->refill();
+
+			const auto n = std::min((size_t)length - i, this->pool.size() - this->pos);
+			Gaussian_noise_generator_philox<R>::scale(this->pool.data() + this->pos, noise + i, n, sigma, mu);
+			this->pos += n;
+			i         += n;
+		}
+	}
+
+protected:
+	// generates the next 'pool.size()' standard normal samples of the stream
+	void refill()
+	{
+		const size_t n = this->pool.size();
+		const size_t h = n / 2;
+
+		// uniform samples in ]0,1[ from the 24 upper bits of the Philox words (2^-24 * w + 2^-25)
+		uint32_t w[4][P];
+		for (size_t b = 0; b < n / 4; b += P)
+		{
+			Gaussian_noise_generator_philox<R>::philox(this->counter + b, this->key, w);
+			for (size_t l = 0; l < 4; l++)
+				for (size_t p = 0; p < P; p++)
+					this->pool[4 * b + l * P + p] = (R)(w[l][p] >> 8) * (R)5.9604645e-08 + (R)2.9802322e-08;
+		}
+		this->counter += n / 4;
+
+		// Box-Muller transform: the first half gives the radius, the second half the angle
+		const mipp::Reg<R> r_m2  = (R)-2.0;
+		const mipp::Reg<R> r_2pi = (R)6.283185307;
+		for (size_t j = 0; j < h; j += mipp::N<R>())
+		{
+			const mipp::Reg<R> u1 = &this->pool[j    ];
+			const mipp::Reg<R> u2 = &this->pool[j + h];
+			const auto radius = mipp::sqrt(mipp::log(u1) * r_m2);
+			mipp::Reg<R> sin, cos;
+			mipp::sincos(u2 * r_2pi, sin, cos);
+			(radius * cos).store(&this->pool[j    ]);
+			(radius * sin).store(&this->pool[j + h]);
+		}
+
+		this->pos = 0;
+	}
+
+	// Philox4x32-10 blocks of the 64-bit counters 'ctr' to 'ctr + P -1' (the lanes are vectorized by the compiler)
+	static inline void philox(const uint64_t ctr, const uint32_t key[2], uint32_t c[4][P])
+	{
+		for (size_t p = 0; p < P; p++)
+		{
+			c[0][p] = (uint32_t)(ctr + p);
+			c[1][p] = (uint32_t)((ctr + p) >> 32);
+			c[2][p] = 0;
+			c[3][p] = 0;
+		}
+
+		uint32_t k0 = key[0], k1 = key[1];
+		for (auto r = 0; r < 10; r++)
+		{
+			for (size_t p = 0; p < P; p++)
+			{
+				const uint64_t p0 = (uint64_t)0xD2511F53 * c[0][p];
+				const uint64_t p1 = (uint64_t)0xCD9E8D57 * c[2][p];
+				const uint32_t n0 = (uint32_t)(p1 >> 32) ^ c[1][p] ^ k0;
+				const uint32_t n2 = (uint32_t)(p0 >> 32) ^ c[3][p] ^ k1;
+				c[0][p] = n0;
+				c[1][p] = (uint32_t)p1;
+				c[2][p] = n2;
+				c[3][p] = (uint32_t)p0;
+			}
+			k0 += 0x9E3779B9;
+			k1 += 0xBB67AE85;
+		}
+	}
+
+	static inline void scale(const R *in, R *out, const size_t n, const R sigma, const R mu)
+	{
+		const mipp::Reg<R> r_sigma = sigma;
+		const mipp::Reg<R> r_mu    = mu;
+
+		size_t i = 0;
+		for (; i + mipp::N<R>() <= n; i += mipp::N<R>())
+		{
+			mipp::Reg<R> r_in;
+			r_in.loadu(in + i);
+			mipp::fmadd(r_in, r_sigma, r_mu).storeu(out + i);
+		}
+		for (; i < n; i++)
+			out[i] = in[i] * sigma + mu;
+	}
+};
+}
+}
+
+#endif /* GAUSSIAN_NOISE_GENERATOR_PHILOX_HPP_ */
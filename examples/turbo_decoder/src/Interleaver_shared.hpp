@@ -0,0 +1,165 @@
+#ifndef INTERLEAVER_SHARED_HPP_
+#define INTERLEAVER_SHARED_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <string>
+
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace module
+{
+/*
+ * Immutable interleaving tables, in gather form:
+ *   - interleave:   itl[i] = nat[pi    [i]]
+ *   - deinterleave: nat[i] = itl[pi_inv[i]]
+ * Both tables are in the same cache line aligned block, they are built once
+ * and shared (read-only) by all the interleavers and all their clones.
+ */
+class Interleaver_table
+{
+public:
+	static constexpr size_t alignment = 64; // cache line size (in bytes)
+
+	const size_t    size;
+	const uint32_t *pi;
+	const uint32_t *pi_inv;
+
+private:
+	std::vector<uint32_t> storage;
+
+public:
+	explicit Interleaver_table(const tools::Interleaver_core<> &core)
+	: size(core.get_size()), pi(nullptr), pi_inv(nullptr)
+	{
+		// both tables start on a cache line
+		const size_t pad    = alignment / sizeof(uint32_t);
+		const size_t stride = ((this->size + pad - 1) / pad) * pad;
+		this->storage.resize(2 * stride + pad);
+
+		auto addr  = reinterpret_cast<uintptr_t>(this->storage.data());
+		auto first = this->storage.data() + ((alignment - addr % alignment) % alignment) / sizeof(uint32_t);
+
+		const auto &lut     = core.get_lut    ();
+		const auto &lut_inv = core.get_lut_inv();
+		std::copy(lut    .begin(), lut    .end(), first         );
+		std::copy(lut_inv.begin(), lut_inv.end(), first + stride);
+
+		this->pi     = first;
+		this->pi_inv = first + stride;
+	}
+
+	Interleaver_table(const Interleaver_table&) = delete;
+	Interleaver_table& operator=(const Interleaver_table&) = delete;
+
+	static std::shared_ptr<const Interleaver_table> build(tools::Interleaver_core<> &core)
+	{
+		if (!core.is_initialized())
+			core.init();
+		return std::make_shared<const Interleaver_table>(core);
+	}
+};
+
+/*
+ * Same tasks and sockets as 'Interleaver<D>' ('itl::tsk' and 'itl::sck') but
+ * the permutation is read from a shared 'Interleaver_table' instead of an
+ * 'Interleaver_core': the clones made by 'tools::Sequence' do not duplicate
+ * it. Note that the table is fixed: there is no re-initialization per frame.
+ */
+template <typename D = int32_t>
+class Interleaver_shared : public Module
+{
+public:
+	inline Task&   operator[](const itl::tsk               t) { return Module::operator[]((size_t)t);                               }
+	inline Socket& operator[](const itl::sck::interleave   s) { return Module::operator[]((size_t)itl::tsk::interleave  )[(size_t)s]; }
+	inline Socket& operator[](const itl::sck::deinterleave s) { return Module::operator[]((size_t)itl::tsk::deinterleave)[(size_t)s]; }
+
+protected:
+	std::shared_ptr<const Interleaver_table> table;
+
+public:
+	explicit Interleaver_shared(std::shared_ptr<const Interleaver_table> table)
+	: Module(), table(table)
+	{
+		const std::string name = "Interleaver_shared";
+		this->set_name(name);
+		this->set_short_name(name);
+
+		if (!this->table)
+			throw tools::invalid_argument(__FILE__, __LINE__, __func__, "'table' can't be null.");
+
+		const auto N = this->table->size;
+
+		auto &p1 = this->create_task("interleave");
+		auto p1s_nat = this->template create_socket_in <D>(p1, "nat", N);
+		auto p1s_itl = this->template create_socket_out<D>(p1, "itl", N);
+		this->create_codelet(p1, [p1s_nat, p1s_itl](Module &m, Task &t, const size_t frame_id) -> int
+		{
+			auto &itl = static_cast<Interleaver_shared<D>&>(m);
+			itl.interleave(static_cast<const D*>(t[p1s_nat].get_dataptr()),
+			               static_cast<      D*>(t[p1s_itl].get_dataptr()),
+			               frame_id);
+			return status_t::SUCCESS;
+		});
+
+		auto &p2 = this->create_task("deinterleave");
+		auto p2s_itl = this->template create_socket_in <D>(p2, "itl", N);
+		auto p2s_nat = this->template create_socket_out<D>(p2, "nat", N);
+		this->create_codelet(p2, [p2s_itl, p2s_nat](Module &m, Task &t, const size_t frame_id) -> int
+		{
+			auto &itl = static_cast<Interleaver_shared<D>&>(m);
+			itl.deinterleave(static_cast<const D*>(t[p2s_itl].get_dataptr()),
+			                 static_cast<      D*>(t[p2s_nat].get_dataptr()),
+			                 frame_id);
+			return status_t::SUCCESS;
+		});
+	}
+
+	virtual ~Interleaver_shared() = default;
+
+	virtual Interleaver_shared<D>* clone() const
+	{
+		auto m = new Interleaver_shared<D>(*this); // shares the table
+		m->deep_copy(*this);
+		return m;
+	}
+
+	const Interleaver_table& get_table() const { return *this->table; }
+
+	// process all the frames if 'frame_id' is -1, only the frame 'frame_id' otherwise
+	void interleave(const D *nat, D *itl, const size_t frame_id = -1) const
+	{
+		this->permute(nat, itl, this->table->pi, frame_id);
+	}
+
+	void deinterleave(const D *itl, D *nat, const size_t frame_id = -1) const
+	{
+		this->permute(itl, nat, this->table->pi_inv, frame_id);
+	}
+
+protected:
+	void permute(const D *in, D *out, const uint32_t *lut, const size_t frame_id) const
+	{
+		const auto N       = this->table->size;
+		const auto f_start = (frame_id == (size_t)-1) ? 0                    : frame_id % this->get_n_frames();
+		const auto f_stop  = (frame_id == (size_t)-1) ? this->get_n_frames() : f_start + 1;
+
+		for (auto f = f_start; f < f_stop; f++)
+		{
+			const D *in_f  = in  + f * N;
+			      D *out_f = out + f * N;
+			// gather loop: sequential writes and no dependency between the iterations
+			// (vectorized with gather instructions when available)
+			for (size_t i = 0; i < N; i++)
+				out_f[i] = in_f[lut[i]];
+		}
+	}
+};
+}
+}
+
+#endif /* INTERLEAVER_SHARED_HPP_ */
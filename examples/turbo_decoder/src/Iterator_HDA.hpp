@@ -0,0 +1,153 @@
+#ifndef ITERATOR_HDA_HPP_
+#define ITERATOR_HDA_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <string>
+
+#include <aff3ct.hpp>
+
+namespace aff3ct
+{
+namespace module
+{
+	namespace ith
+	{
+		enum class tsk : size_t { iterate, SIZE };
+
+		namespace sck
+		{
+			enum class iterate : size_t { Y_N1, Y_N2, out, status };
+		}
+	}
+
+/*
+ * Iterator with an early termination criterion (Hard Decision Aided): the
+ * loop is stopped as soon as the hard decisions on the a posteriori LLRs of a
+ * SISO decoder are the same than at the previous iteration, or after 'limit'
+ * iterations. The a posteriori LLRs are the sum of the input of the decoder
+ * 'Y_N1' (channel + a priori LLRs) and of its extrinsic output 'Y_N2'.
+ *
+ * 'out' drives the control socket of a 'Switcher::commute' task: 0 = continue
+ * the loop, 1 = exit the loop. A 'Switcher' takes the same path for all the
+ * frames of a task, so when the module processes several frames the loop is
+ * stopped only when all of them agree.
+ */
+template <typename R = float>
+class Iterator_HDA : public Module
+{
+public:
+	inline Task&   operator[](const ith::tsk          t) { return Module::operator[]((size_t)t);                          }
+	inline Socket& operator[](const ith::sck::iterate s) { return Module::operator[]((size_t)ith::tsk::iterate)[(size_t)s]; }
+
+protected:
+	const int           N;
+	const size_t        limit;
+	size_t              counter;   // number of iterations of the frames in progress
+	std::vector<int8_t> decisions; // hard decisions of the previous iteration
+	size_t              n_frames_done;
+	size_t              n_iterations;
+
+public:
+	Iterator_HDA(const int N, const size_t limit)
+	: Module(), N(N), limit(limit), counter(0), decisions(N, 0), n_frames_done(0), n_iterations(0)
+	{
+		const std::string name = "Iterator_HDA";
+		this->set_name(name);
+		this->set_short_name(name);
+
+		if (N <= 0)
+			throw tools::invalid_argument(__FILE__, __LINE__, __func__, "'N' has to be greater than 0.");
+		if (limit == 0)
+			throw tools::invalid_argument(__FILE__, __LINE__, __func__, "'limit' has to be greater than 0.");
+
+		// all the frames are processed at once (one decision for all of them)
+		this->set_single_wave(true);
+
+		auto &p = this->create_task("iterate");
+		auto ps_Y_N1 = this->template create_socket_in <R     >(p, "Y_N1", N);
+		auto ps_Y_N2 = this->template create_socket_in <R     >(p, "Y_N2", N);
+		auto ps_out  = this->template create_socket_out<int8_t>(p, "out",  1);
+		this->create_codelet(p, [ps_Y_N1, ps_Y_N2, ps_out](Module &m, Task &t, const size_t frame_id) -> int
+		{
+			auto &ite = static_cast<Iterator_HDA<R>&>(m);
+			ite.iterate(static_cast<const R*     >(t[ps_Y_N1].get_dataptr()),
+			            static_cast<const R*     >(t[ps_Y_N2].get_dataptr()),
+			            static_cast<      int8_t*>(t[ps_out ].get_dataptr()),
+			            frame_id);
+			return status_t::SUCCESS;
+		});
+	}
+
+	virtual ~Iterator_HDA() = default;
+
+	virtual Iterator_HDA<R>* clone() const
+	{
+		auto m = new Iterator_HDA<R>(*this);
+		m->deep_copy(*this);
+		return m;
+	}
+
+	virtual void set_n_frames(const size_t n_frames)
+	{
+		if (this->get_n_frames() != n_frames)
+		{
+			Module::set_n_frames(n_frames);
+			this->counter = 0;
+			this->decisions.assign(n_frames * this->N, 0);
+		}
+	}
+
+	// process all the frames of the task
+	void iterate(const R *Y_N1, const R *Y_N2, int8_t *out, const size_t /*frame_id*/ = -1)
+	{
+		const auto n_frames = this->get_n_frames();
+
+		// the first iteration has nothing to compare with
+		bool agree = this->counter > 0;
+		for (size_t f = 0; f < n_frames; f++)
+			agree = this->_update(Y_N1 + f * this->N, Y_N2 + f * this->N, f) && agree;
+
+		const int8_t stop = (agree || ++this->counter >= this->limit) ? 1 : 0;
+		if (stop)
+		{
+			this->n_iterations  += (this->counter + (agree ? 1 : 0)) * n_frames;
+			this->n_frames_done += n_frames;
+			this->counter = 0;
+		}
+		std::fill(out, out + n_frames, stop);
+	}
+
+	// forget the frames in progress (e.g. after an interrupted loop) and the statistics
+	void reset()
+	{
+		this->counter       = 0;
+		this->n_frames_done = 0;
+		this->n_iterations  = 0;
+	}
+
+	size_t get_n_frames_done() const { return this->n_frames_done; }
+	size_t get_n_iterations () const { return this->n_iterations;  }
+
+protected:
+	// store the hard decisions of the frame 'f', returns true if they did not change
+	bool _update(const R *Y_N1, const R *Y_N2, const size_t f)
+	{
+		auto dec = this->decisions.data() + f * this->N;
+
+		bool same = true;
+		for (auto i = 0; i < this->N; i++)
+		{
+			// the fixed-point LLRs are promoted to 'int' by the sum (no saturation)
+			const int8_t d = (Y_N1[i] + Y_N2[i]) < 0 ? 1 : 0;
+			same = same && (d == dec[i]);
+			dec[i] = d;
+		}
+		return same;
+	}
+};
+}
+}
+
+#endif /* ITERATOR_HDA_HPP_ */
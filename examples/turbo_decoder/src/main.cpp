@@ -10,15 +10,249 @@
 #include <string>
 #include <thread>
 #include <random>
+#include <cmath>
 
 #include <aff3ct.hpp>
 using namespace aff3ct;
 using namespace aff3ct::module;
 
+#include "Iterator_HDA.hpp"
+#include "Interleaver_shared.hpp"
+#include "Decoder_RSC_BCJR_inter_generic.hpp"
+#include "Gaussian_noise_generator_philox.hpp"
+#include "Thread_placement.hpp"
+#include "Monitor_BFER_counter.hpp"
+#include "Checkpoint.hpp"
+
+// decode with quantized LLRs (uncomment one of the two lines)
+//#define FIXED_POINT_16
+//#define FIXED_POINT_8
+
+// decode mipp::N<float>() frames at once with the inter-frame SIMD BCJR (floating-point only)
+//#define BCJR_INTER
+
+// generate the channel noise by blocks with the counter-based PRNG (keyed by the seed of each clone of the channel)
+//#define PHILOX_NOISE
+
+#if defined(BCJR_INTER) && (defined(FIXED_POINT_16) || defined(FIXED_POINT_8))
+#error "The inter-frame BCJR decoder is only available in floating-point."
+#endif
+
+#if defined(FIXED_POINT_16)
+using B = int16_t; // type of the bits
+using Q = int16_t; // type of the LLRs in the decoder
+constexpr short Q_FIX_POS = 3; // number of bits of the fractional part
+constexpr short Q_SAT_POS = 6; // saturation position (number of bits)
+#elif defined(FIXED_POINT_8)
+using B = int8_t;
+using Q = int8_t;
+constexpr short Q_FIX_POS = 2;
+constexpr short Q_SAT_POS = 6;
+#else
+using B = int;
+using Q = float;
+#endif
+
+#if defined(FIXED_POINT_16) || defined(FIXED_POINT_8)
+// the max-star approximation is not available in fixed point
+using Decoder_BCJR = Decoder_RSC_BCJR_seq_generic_std<B,Q,Q,tools::max<Q>,tools::max<Q>>;
+#elif defined(BCJR_INTER)
+using Decoder_BCJR = Decoder_RSC_BCJR_inter_generic<B>;
+#else
+using Decoder_BCJR = Decoder_RSC_BCJR_seq_generic_std<B,Q>;
+#endif
+
 namespace aff3ct { namespace tools {
-using Monitor_BFER_reduction = Monitor_reduction<module::Monitor_BFER<>>;
+using Monitor_BFER_reduction = Monitor_reduction<module::Monitor_BFER<B>>;
 } }
 
+#ifdef BCJR_INTER
+// decode the same noisy frames with the inter-frame BCJR and with the max-log BCJR of the library: the extrinsic LLRs
+// have to be the same (up to the float rounding), the BERs are displayed side by side
+void check_bcjr_inter(const unsigned K, const unsigned N, const std::vector<std::vector<int>> &trellis,
+                      const float ebn0, const size_t n_calls = 1000)
+{
+	Decoder_RSC_BCJR_inter_generic<B> dec_inter(K, trellis);
+	Decoder_RSC_BCJR_seq_generic_std<B,float,float,tools::max<float>,tools::max<float>> dec_ref(K, trellis);
+	const auto n_frames = (size_t)dec_inter.get_n_frames_per_call();
+
+	Source_random<B> src(K, 42);
+	Encoder_RSC_generic_sys<B> enc(K, N);
+	Modem_BPSK_fast<B> mdm(N);
+	Channel_AWGN_LLR<> chn(N, aff3ct::tools::Gaussian_noise_generator_implem::FAST, 43);
+	Monitor_BFER<B> mnt_inter(K), mnt_ref(K);
+	for (auto m : std::vector<Module*>({&dec_inter, &dec_ref, &src, &enc, &mdm, &chn, &mnt_inter, &mnt_ref}))
+		m->set_n_frames(n_frames);
+
+	const auto esn0 = tools::ebn0_to_esn0(ebn0, (K * 1.f) / (N * 1.f), 1);
+	std::vector<float> sigma(n_frames, tools::esn0_to_sigma(esn0, 1));
+
+	enc      [enc::sck::encode      ::U_K ] = src      [src::sck::generate   ::U_K ];
+	mdm      [mdm::sck::modulate    ::X_N1] = enc      [enc::sck::encode     ::X_N ];
+	chn      [chn::sck::add_noise   ::X_N ] = mdm      [mdm::sck::modulate   ::X_N2];
+	mdm      [mdm::sck::demodulate  ::Y_N1] = chn      [chn::sck::add_noise  ::Y_N ];
+	dec_inter[dec::sck::decode_siso ::Y_N1] = mdm      [mdm::sck::demodulate ::Y_N2];
+	dec_ref  [dec::sck::decode_siso ::Y_N1] = mdm      [mdm::sck::demodulate ::Y_N2];
+	dec_inter[dec::sck::decode_siho ::Y_N ] = mdm      [mdm::sck::demodulate ::Y_N2];
+	dec_ref  [dec::sck::decode_siho ::Y_N ] = mdm      [mdm::sck::demodulate ::Y_N2];
+	mnt_inter[mnt::sck::check_errors::U   ] = src      [src::sck::generate   ::U_K ];
+	mnt_inter[mnt::sck::check_errors::V   ] = dec_inter[dec::sck::decode_siho::V_K ];
+	mnt_ref  [mnt::sck::check_errors::U   ] = src      [src::sck::generate   ::U_K ];
+	mnt_ref  [mnt::sck::check_errors::V   ] = dec_ref  [dec::sck::decode_siho::V_K ];
+	chn      [chn::sck::add_noise   ::CP  ] = sigma;
+	mdm      [mdm::sck::demodulate  ::CP  ] = sigma;
+
+	float max_diff = 0.f, max_ext = 0.f;
+	for (size_t c = 0; c < n_calls; c++)
+	{
+		src      [src::tsk::generate    ].exec();
+		enc      [enc::tsk::encode      ].exec();
+		mdm      [mdm::tsk::modulate    ].exec();
+		chn      [chn::tsk::add_noise   ].exec();
+		mdm      [mdm::tsk::demodulate  ].exec();
+		dec_inter[dec::tsk::decode_siso ].exec();
+		dec_ref  [dec::tsk::decode_siso ].exec();
+		dec_inter[dec::tsk::decode_siho ].exec();
+		dec_ref  [dec::tsk::decode_siho ].exec();
+		mnt_inter[mnt::tsk::check_errors].exec();
+		mnt_ref  [mnt::tsk::check_errors].exec();
+
+		const auto ext_inter = static_cast<const float*>(dec_inter[dec::sck::decode_siso::Y_N2].get_dataptr());
+		const auto ext_ref   = static_cast<const float*>(dec_ref  [dec::sck::decode_siso::Y_N2].get_dataptr());
+		for (size_t i = 0; i < n_frames * N; i++)
+		{
+			max_diff = std::max(max_diff, std::abs(ext_inter[i] - ext_ref[i]));
+			max_ext  = std::max(max_ext,  std::abs(ext_ref[i]));
+		}
+	}
+
+	std::cout << "# BCJR_INTER check (K = " << K << ", Eb/N0 = " << ebn0 << " dB, " << mnt_ref.get_n_analyzed_fra()
+	          << " frames): max |ext - ext_ref| = " << max_diff << " (max |ext_ref| = " << max_ext << "), BER = "
+	          << mnt_inter.get_ber() << " (ref = " << mnt_ref.get_ber() << ")" << std::endl;
+
+	if (max_diff > 1e-3f * std::max(1.f, max_ext))
+		throw tools::runtime_error(__FILE__, __LINE__, __func__, "The extrinsic LLRs of the inter-frame BCJR do not "
+		                           "match the ones of 'Decoder_RSC_BCJR_seq_generic_std'.");
+}
+#endif
+
+// decode the same noisy frames with the early terminated turbo loop ('Iterator_HDA') and with 'I' iterations for all
+// the frames: the FERs and BERs are displayed side by side
+void check_early_termination(const unsigned K, const unsigned N_, const unsigned N, const unsigned I,
+                             const std::vector<std::vector<int>> &trellis_n,
+                             const std::vector<std::vector<int>> &trellis_i,
+                             std::shared_ptr<const Interleaver_table> itl_table, const float ebn0,
+                             const size_t n_calls = 1000)
+{
+	Decoder_BCJR dec_n(K, trellis_n);
+	Decoder_BCJR dec_i(N_, trellis_i);
+#ifdef BCJR_INTER
+	const auto n_frames = (size_t)dec_n.get_n_frames_per_call();
+#else
+	const size_t n_frames = 1;
+#endif
+
+	Source_random<B> src(K, 44);
+	Encoder_RSC_generic_sys<B> enc_n(K, N_);
+	Encoder_RSC_generic_sys<B> enc_i(N_,N);
+	Interleaver_shared<B> itl_bit(itl_table);
+	Interleaver_shared<Q> itl_llr(itl_table);
+	Modem_BPSK_fast<B> mdm(N);
+	Channel_AWGN_LLR<> chn(N, aff3ct::tools::Gaussian_noise_generator_implem::FAST, 45);
+	Extractor_RSC<B,Q> ext(N_, N, (N-N_)/2);
+	Iterator_HDA<Q> hda(N, I);
+	Monitor_BFER<B> mnt_hda(K), mnt_fix(K);
+#if defined(FIXED_POINT_16) || defined(FIXED_POINT_8)
+	Quantizer_pow2<float,Q> qnt(N, Q_FIX_POS, Q_SAT_POS);
+	qnt.set_n_frames(n_frames);
+#endif
+	for (auto m : std::vector<Module*>({&dec_n, &dec_i, &src, &enc_n, &enc_i, &itl_bit, &itl_llr, &mdm, &chn, &ext,
+	                                    &hda, &mnt_hda, &mnt_fix}))
+		m->set_n_frames(n_frames);
+
+	const auto esn0 = tools::ebn0_to_esn0(ebn0, (K * 1.f) / (N * 1.f), 1);
+	std::vector<float> sigma(n_frames, tools::esn0_to_sigma(esn0, 1));
+
+	// same turbo loop as in 'main' without the 'Switcher': the loop is unrolled below
+	enc_n  [enc::sck::encode             ::U_K  ] = src    [src::sck::generate           ::U_K   ];
+	itl_bit[itl::sck::interleave         ::nat  ] = enc_n  [enc::sck::encode             ::X_N   ];
+	enc_i  [enc::sck::encode             ::U_K  ] = itl_bit[itl::sck::interleave         ::itl   ];
+	mdm    [mdm::sck::modulate           ::X_N1 ] = enc_i  [enc::sck::encode             ::X_N   ];
+	chn    [chn::sck::add_noise          ::X_N  ] = mdm    [mdm::sck::modulate           ::X_N2  ];
+	mdm    [mdm::sck::demodulate         ::Y_N1 ] = chn    [chn::sck::add_noise          ::Y_N   ];
+#if defined(FIXED_POINT_16) || defined(FIXED_POINT_8)
+	qnt    [qnt::sck::process            ::Y_N1 ] = mdm    [mdm::sck::demodulate         ::Y_N2  ];
+	auto &llr = qnt[qnt::sck::process::Y_N2];
+#else
+	auto &llr = mdm[mdm::sck::demodulate::Y_N2];
+#endif
+	ext    [ext::sck::add_sys_and_ext_llr::ext  ] = itl_llr[itl::sck::interleave         ::itl   ];
+	ext    [ext::sck::add_sys_and_ext_llr::Y_N1 ] = llr;
+	dec_i  [dec::sck::decode_siso        ::Y_N1 ] = ext    [ext::sck::add_sys_and_ext_llr::Y_N2  ];
+	ext    [ext::sck::get_sys_llr        ::Y_N  ] = dec_i  [dec::sck::decode_siso        ::Y_N2  ];
+	itl_llr[itl::sck::deinterleave       ::itl  ] = ext    [ext::sck::get_sys_llr        ::Y_K   ];
+	hda    [ith::sck::iterate            ::Y_N1 ] = ext    [ext::sck::add_sys_and_ext_llr::Y_N2  ];
+	hda    [ith::sck::iterate            ::Y_N2 ] = dec_i  [dec::sck::decode_siso        ::Y_N2  ];
+	dec_n  [dec::sck::decode_siso        ::Y_N1 ] = itl_llr[itl::sck::deinterleave       ::nat   ];
+	itl_llr[itl::sck::interleave         ::nat  ] = dec_n  [dec::sck::decode_siso        ::Y_N2  ];
+	dec_n  [dec::sck::decode_siho        ::Y_N  ] = itl_llr[itl::sck::deinterleave       ::nat   ];
+	mnt_hda[mnt::sck::check_errors       ::U    ] = src    [src::sck::generate           ::U_K   ];
+	mnt_hda[mnt::sck::check_errors       ::V    ] = dec_n  [dec::sck::decode_siho        ::V_K   ];
+	mnt_fix[mnt::sck::check_errors       ::U    ] = src    [src::sck::generate           ::U_K   ];
+	mnt_fix[mnt::sck::check_errors       ::V    ] = dec_n  [dec::sck::decode_siho        ::V_K   ];
+	chn    [chn::sck::add_noise          ::CP   ] = sigma;
+	mdm    [mdm::sck::demodulate         ::CP   ] = sigma;
+
+	auto a_priori = static_cast<Q*>(itl_llr[itl::sck::interleave::itl].get_dataptr());
+	auto stop     = static_cast<const int8_t*>(hda[ith::sck::iterate::out].get_dataptr());
+	for (size_t c = 0; c < n_calls; c++)
+	{
+		src    [src::tsk::generate  ].exec();
+		enc_n  [enc::tsk::encode    ].exec();
+		itl_bit[itl::tsk::interleave].exec();
+		enc_i  [enc::tsk::encode    ].exec();
+		mdm    [mdm::tsk::modulate  ].exec();
+		chn    [chn::tsk::add_noise ].exec();
+		mdm    [mdm::tsk::demodulate].exec();
+#if defined(FIXED_POINT_16) || defined(FIXED_POINT_8)
+		qnt    [qnt::tsk::process   ].exec();
+#endif
+		std::fill(a_priori, a_priori + n_frames * N_, (Q)0);
+
+		// the early terminated loop decides at the first 'stop' of 'hda', the reference one after 'I' iterations
+		bool hda_done = false;
+		for (size_t i = 1; i <= I; i++)
+		{
+			ext    [ext::tsk::add_sys_and_ext_llr].exec();
+			dec_i  [dec::tsk::decode_siso        ].exec();
+			ext    [ext::tsk::get_sys_llr        ].exec();
+			itl_llr[itl::tsk::deinterleave       ].exec();
+			if (!hda_done)
+			{
+				hda[ith::tsk::iterate].exec();
+				hda_done = stop[0] != 0;
+				if (hda_done)
+				{
+					dec_n  [dec::tsk::decode_siho ].exec();
+					mnt_hda[mnt::tsk::check_errors].exec();
+				}
+			}
+			if (i < I)
+			{
+				dec_n  [dec::tsk::decode_siso].exec();
+				itl_llr[itl::tsk::interleave ].exec();
+			}
+		}
+		dec_n  [dec::tsk::decode_siho ].exec();
+		mnt_fix[mnt::tsk::check_errors].exec();
+	}
+
+	std::cout << "# Early termination check (Eb/N0 = " << ebn0 << " dB, " << mnt_fix.get_n_analyzed_fra()
+	          << " frames): FER = " << mnt_hda.get_fer() << ", BER = " << mnt_hda.get_ber() << " with "
+	          << (float)hda.get_n_iterations() / (float)hda.get_n_frames_done() << " iterations on average (" << I
+	          << " iterations: FER = " << mnt_fix.get_fer() << ", BER = " << mnt_fix.get_ber() << ")" << std::endl;
+}
+
 int main(int argc, char** argv)
 {
 	// get the AFF3CT version
@@ -38,43 +272,63 @@ int main(int argc, char** argv)
 	unsigned I = 4;
 	unsigned FE = 100;
 	unsigned nthreads = std::thread::hardware_concurrency();
+	std::string thread_placement = "NONE"; // threads pinning: "NONE", "COMPACT", "SCATTER" or a list of PUIDs "0,2,..."
+	std::string checkpoint_path = ""; // checkpoint/resume file of the sweep, e.g. "turbo_decoder.ckpt" ("" = disabled)
+	unsigned checkpoint_period = 60; // in seconds
 
 	float R = (K * 1.f) / (N * 1.f);
 	float ebn0_min = 2.5f;
 	float ebn0_max = 3.31f;
 	float ebn0_step = 0.1f;
 
-	Source_random_fast<> src(K, 12);
+	Source_random_fast<B> src(K, 12);
 
 	// Build DVBS-RCS2 Turbo encoder.
-	Encoder_RSC_generic_sys<> enc_n(K, N_);
-	Encoder_RSC_generic_sys<> enc_i(N_,N);
+	Encoder_RSC_generic_sys<B> enc_n(K, N_);
+	Encoder_RSC_generic_sys<B> enc_i(N_,N);
 
 	// Build DVBS-RCS2 Interleaver.
 	tools::Interleaver_core_random<> itl_core(N_);
-	Interleaver<int32_t> itl_bit(itl_core);
-	Interleaver<float> itl_llr(itl_core);
+	// one read-only permutation table for the two interleavers and all their clones
+	auto itl_table = Interleaver_table::build(itl_core);
+	Interleaver_shared<B> itl_bit(itl_table);
+	Interleaver_shared<Q> itl_llr(itl_table);
 
 	// Build DVBS-RCS2 Trubo decoder.
 	auto trellis_n = enc_n.get_trellis();
 	auto trellis_i = enc_i.get_trellis();
 
-	Decoder_RSC_BCJR_seq_generic_std<> dec_n(K,trellis_n);
+#ifdef BCJR_INTER
+	check_bcjr_inter(K, N_, trellis_n, ebn0_min);
+#endif
+	check_early_termination(K, N_, N, I, trellis_n, trellis_i, itl_table, ebn0_min);
+
+	Decoder_BCJR dec_n(K,trellis_n);
 	dec_n.set_custom_name("dec_n");
-	Decoder_RSC_BCJR_seq_generic_std<> dec_i(N_,trellis_i);
+	Decoder_BCJR dec_i(N_,trellis_i);
 	dec_i.set_custom_name("dec_i");
 
-	Modem_BPSK_fast<> mdm(N);
-	Extractor_RSC<> ext(N_, N, (N-N_)/2);
+	Modem_BPSK_fast<B> mdm(N);
+	Extractor_RSC<B,Q> ext(N_, N, (N-N_)/2);
+#ifdef PHILOX_NOISE
+	tools::Gaussian_noise_generator_philox<> gen;
+	Channel_AWGN_LLR<> chn(N, gen);
+#else
 	Channel_AWGN_LLR<> chn(N, aff3ct::tools::Gaussian_noise_generator_implem::FAST);
-	Switcher swi(2, N_, typeid(float));
+#endif
+	Switcher swi(2, N_, typeid(Q));
 
-	Iterator cnt(I);
-	Initializer<float> zeros(N_);
+	// stop the turbo loop of a frame when the hard decisions on the a posteriori LLRs of 'dec_i' do not change anymore
+	Iterator_HDA<Q> cnt(N, I);
+	Initializer<Q> zeros(N_);
 	zeros.set_custom_name("Init_zeros");
-	zeros.set_init_data(std::vector<float>(N_, 0.f));
+	zeros.set_init_data(std::vector<Q>(N_, (Q)0));
+
+	Monitor_BFER<B> mnt(K, FE);
 
-	Monitor_BFER<> mnt(K, FE);
+#if defined(FIXED_POINT_16) || defined(FIXED_POINT_8)
+	Quantizer_pow2<float,Q> qnt(N, Q_FIX_POS, Q_SAT_POS);
+#endif
 
 	std::vector<float> sigma(1);
 
@@ -84,14 +338,23 @@ int main(int argc, char** argv)
 	mdm    [mdm::sck::modulate           ::X_N1 ] = enc_i  [enc::sck::encode             ::X_N   ];
 	chn    [chn::sck::add_noise          ::X_N  ] = mdm    [mdm::sck::modulate           ::X_N2  ];
 	mdm    [mdm::sck::demodulate         ::Y_N1 ] = chn    [chn::sck::add_noise          ::Y_N   ];
-	zeros  [ini::tsk::initialize                ] = mdm    [mdm::sck::demodulate         ::Y_N2  ];
+#if defined(FIXED_POINT_16) || defined(FIXED_POINT_8)
+	// quantize the LLRs right after the demodulation, all the turbo loop runs on Q
+	qnt    [qnt::sck::process            ::Y_N1 ] = mdm    [mdm::sck::demodulate         ::Y_N2  ];
+	auto &llr = qnt[qnt::sck::process::Y_N2];
+#else
+	auto &llr = mdm[mdm::sck::demodulate::Y_N2];
+#endif
+	zeros  [ini::tsk::initialize                ] = llr;
 	swi    [swi::tsk::select             ][1    ] = zeros  [ini::sck::initialize         ::out   ];
 	ext    [ext::sck::add_sys_and_ext_llr::ext  ] = swi    [swi::tsk::select             ][2     ];
-	ext    [ext::sck::add_sys_and_ext_llr::Y_N1 ] = mdm    [mdm::sck::demodulate         ::Y_N2  ];
+	ext    [ext::sck::add_sys_and_ext_llr::Y_N1 ] = llr;
 	dec_i  [dec::sck::decode_siso        ::Y_N1 ] = ext    [ext::sck::add_sys_and_ext_llr::Y_N2  ];
 	ext    [ext::sck::get_sys_llr        ::Y_N  ] = dec_i  [dec::sck::decode_siso        ::Y_N2  ];
 	itl_llr[itl::sck::deinterleave       ::itl  ] = ext    [ext::sck::get_sys_llr        ::Y_K   ];
-	swi    [swi::tsk::commute            ][1    ] = cnt    [ite::sck::iterate            ::out   ];
+	cnt    [ith::sck::iterate            ::Y_N1 ] = ext    [ext::sck::add_sys_and_ext_llr::Y_N2  ];
+	cnt    [ith::sck::iterate            ::Y_N2 ] = dec_i  [dec::sck::decode_siso        ::Y_N2  ];
+	swi    [swi::tsk::commute            ][1    ] = cnt    [ith::sck::iterate            ::out   ];
 	swi    [swi::tsk::commute            ][0    ] = itl_llr[itl::sck::deinterleave       ::nat   ];
 	dec_n  [dec::sck::decode_siso        ::Y_N1 ] = swi    [swi::tsk::commute            ][2     ];
 	itl_llr[itl::sck::interleave         ::nat  ] = dec_n  [dec::sck::decode_siso        ::Y_N2  ];
@@ -99,11 +362,16 @@ int main(int argc, char** argv)
 	dec_n  [dec::sck::decode_siho        ::Y_N  ] = swi    [swi::tsk::commute            ][3     ];
 	mnt    [mnt::sck::check_errors       ::U    ] = src    [src::sck::generate           ::U_K   ];
 	mnt    [mnt::sck::check_errors       ::V    ] = dec_n  [dec::sck::decode_siho        ::V_K   ];
-	cnt    [ite::tsk::iterate                   ] = ext    [ext::sck::add_sys_and_ext_llr::status];
 	chn    [chn::sck::add_noise          ::CP   ] = sigma;
 	mdm    [mdm::sck::demodulate         ::CP   ] = sigma;
 
-	tools::Sequence sequence(src[src::tsk::generate], nthreads);
+	// the threads are pinned before cloning the modules (first-touch allocation on their NUMA node)
+	const tools::Thread_placement placement(thread_placement);
+	tools::Sequence sequence(src[src::tsk::generate], nthreads, placement.is_pinning(), placement.get_puids(nthreads));
+#ifdef BCJR_INTER
+	// one frame per SIMD lane in the BCJR decoders
+	sequence.set_n_frames(dec_n.get_n_frames_per_call());
+#endif
 
 	// std::ofstream sequence_dot("sequence.dot");
 	// sequence.export_dot(sequence_dot);
@@ -122,15 +390,39 @@ int main(int argc, char** argv)
 				tsk->set_fast(true);
 		}
 
-	tools::Monitor_BFER_reduction monitor_red(sequence.get_modules<aff3ct::module::Monitor_BFER<>>());
+	tools::Monitor_BFER_reduction monitor_red(sequence.get_modules<aff3ct::module::Monitor_BFER<B>>());
+	// low contention stop criterion: per thread frame error counters, exact reduction every 500 ms by one thread
+	tools::Monitor_BFER_counter<B> fe_counter(monitor_red, sequence.get_modules<aff3ct::module::Monitor_BFER<B>>(), FE);
 	tools::Sigma<> noise;
 	tools::Reporter_noise<> rep_noise(noise, true);
-	tools::Reporter_BFER<> rep_bfer(monitor_red);
-	tools::Reporter_throughput<> rep_thr(monitor_red);
+	tools::Reporter_BFER<B> rep_bfer(monitor_red);
+	tools::Reporter_throughput<B> rep_thr(monitor_red);
 	tools::Terminal_std terminal({&rep_noise, &rep_bfer, &rep_thr});
 
-	// set different seeds in the modules that uses PRNG
-	std::mt19937 prng;
+	std::vector<float> ebn0s; // the SNR points of the sweep
+	for (auto ebn0 = ebn0_min; ebn0 < ebn0_max; ebn0 += ebn0_step)
+		ebn0s.push_back(ebn0);
+
+	// resume the sweep if a checkpoint of the same simulation exists
+	const auto key = tools::Checkpoint::make_key("turbo;K=" + std::to_string(K) + ";N=" + std::to_string(N) +
+	                                             ";I=" + std::to_string(I) + ";FE=" + std::to_string(FE) +
+	                                             ";Q=" + std::to_string(sizeof(Q)) +
+	                                             ";ebn0=" + std::to_string(ebn0_min) + ":" + std::to_string(ebn0_max) +
+	                                             ":" + std::to_string(ebn0_step));
+	tools::Checkpoint checkpoint(checkpoint_path, std::chrono::seconds(checkpoint_path.empty() ? 0 : checkpoint_period));
+	tools::Checkpoint::State state = {key, 0, 0, 0, 0, 0};
+	const bool resumed = !checkpoint_path.empty() && checkpoint.load(key, state);
+	if (resumed)
+	{
+		state.n_resumes++;
+		std::cout << "# Resume from '" << checkpoint_path << "': Eb/N0 = " << ebn0s[std::min((size_t)state.point,
+		             ebn0s.size() -1)] << " dB, " << state.n_fra << " frames, " << state.n_fe << " frame errors"
+		          << std::endl;
+	}
+
+	// set different seeds in the modules that uses PRNG (new seeds after each resume), in the order of the threads: the
+	// seed (= the Philox key with PHILOX_NOISE) of the channel of a thread does not depend on the order of the cloning
+	std::mt19937 prng(std::mt19937::default_seed + state.n_resumes);
 	for (auto &m : sequence.get_modules<tools::Interface_set_seed>())
 		m->set_seed(prng());
 
@@ -138,34 +430,80 @@ int main(int argc, char** argv)
 	terminal.legend();
 
 	// loop over the various SNRs
-	for (auto ebn0 = ebn0_min; ebn0 < ebn0_max; ebn0 += ebn0_step)
+	for (size_t point = state.point; point < ebn0s.size(); point++)
 	{
+		const auto ebn0 = ebn0s[point];
+
 		// compute the current sigma for the channel noise
 		const auto esn0 = tools::ebn0_to_esn0(ebn0, R, 1);
 		std::fill(sigma.begin(), sigma.end(), tools::esn0_to_sigma(esn0, 1));
 
 		noise.set_values(sigma[0], ebn0, esn0);
 
+		// restore the monitor counters of the checkpointed SNR point (in the monitor of the first thread)
+		if (resumed && point == state.point && state.n_fra)
+		{
+			module::Monitor_BFER<B>::Attributes attributes;
+			attributes.n_analyzed_frames = state.n_fra;
+			attributes.n_fe              = state.n_fe;
+			attributes.n_be              = state.n_be;
+			sequence.get_modules<module::Monitor_BFER<B>>()[0]->collect(attributes);
+			fe_counter.add_fe(state.n_fe);
+		}
+
 		// display the performance (BER and FER) in real time (in a separate thread)
 		terminal.start_temp_report();
 
-		// execute the simulation sequence (multi-threaded)
-		sequence.exec([&monitor_red, &terminal]() { return monitor_red.is_done() || terminal.is_interrupt(); });
+		// execute the simulation sequence (multi-threaded), it is stopped to save a checkpoint periodically
+		do
+		{
+			sequence.exec([&fe_counter, &terminal, &checkpoint]()
+			{
+				return fe_counter.is_done() || terminal.is_interrupt() || checkpoint.is_due();
+			});
+
+			// final (or intermediate) reduction
+			monitor_red.reduce();
 
-		// final reduction
-		monitor_red.reduce();
+			if (!checkpoint_path.empty())
+				checkpoint.save({key, (uint32_t)point, state.n_resumes, monitor_red.get_n_analyzed_fra(),
+				                 monitor_red.get_n_fe(), monitor_red.get_n_be()});
+		}
+		while (!fe_counter.is_done() && !terminal.is_interrupt());
 
 		// display the performance (BER and FER) in the terminal
 		terminal.final_report();
 
+		// average number of turbo iterations per frame (early termination)
+		size_t n_frames_done = 0, n_iterations = 0;
+		for (auto &c : sequence.get_modules<Iterator_HDA<Q>>())
+		{
+			n_frames_done += c->get_n_frames_done();
+			n_iterations  += c->get_n_iterations();
+		}
+		if (n_frames_done)
+			std::cout << "#    ** Average number of iterations = " << (float)n_iterations / (float)n_frames_done
+			          << " (max = " << I << ")" << std::endl;
+
 		// reset the monitor and the terminal for the next SNR
 		monitor_red.reset();
+		fe_counter.reset();
 		terminal.reset();
+		for (auto &c : sequence.get_modules<Iterator_HDA<Q>>())
+			c->reset();
 
-		// if user pressed Ctrl+c twice, exit the SNRs loop
+		// if user pressed Ctrl+c twice, exit the SNRs loop (the checkpoint keeps the current SNR point)
 		if (terminal.is_over()) break;
+
+		// the SNR point is over
+		if (!checkpoint_path.empty())
+			checkpoint.save({key, (uint32_t)(point +1), state.n_resumes, 0, 0, 0});
 	}
 
+	// the sweep is complete: the next run starts from the beginning
+	if (!checkpoint_path.empty() && !terminal.is_over())
+		checkpoint.remove();
+
 	// display the statistics of the tasks (if enabled)
 	std::cout << "#" << std::endl;
 	tools::Stats::show(sequence.get_modules_per_types(), true);